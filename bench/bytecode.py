@@ -0,0 +1,90 @@
+# Copyright (c) 2022-present, Trail of Bits, Inc.
+
+# Compares load and store times of the textual and the bytecode form of
+# modules, on a generated translation unit with many functions.
+#
+#   python3 bench/bytecode.py --bin-dir <build>/bin [--runs 10] [--functions 2000]
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+function = '''
+struct node_{0} {{ int value; const unsigned long weight; struct node_{0} *next; }};
+
+unsigned long walk_{0}(struct node_{0} *node, int limit) {{
+    unsigned long sum = 0;
+    int values[8] = {{ 0 }};
+    for (int i = 0; node && i < limit; ++i, node = node->next) {{
+        values[i % 8] += node->value;
+        sum += node->weight * (unsigned long)values[i % 8];
+    }}
+    if (sum > {0}u)
+        return sum - {0}u;
+    return sum;
+}}
+'''
+
+def generate(functions):
+    return ''.join(function.format(i) for i in range(functions))
+
+def measure(args, runs):
+    times = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        subprocess.run(args, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        times.append((time.perf_counter() - start) * 1000)
+    return times
+
+def main():
+    parser = argparse.ArgumentParser(description='text and bytecode load/store times')
+    parser.add_argument('--bin-dir', default='', help='directory with vast tools')
+    parser.add_argument('--runs', type=int, default=10)
+    parser.add_argument('--functions', type=int, default=2000,
+                        help='number of functions of the generated unit')
+    opts = parser.parse_args()
+
+    tool = lambda name: os.path.join(opts.bin_dir, name)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'input.c')
+        text = os.path.join(tmp, 'input.mlir')
+        binary = os.path.join(tmp, 'input.vbc')
+        with open(src, 'w') as f:
+            f.write(generate(opts.functions))
+
+        cc = [tool('vast-cc'), '--ccopts', '-xc', '--from-source', src]
+        subprocess.run(cc + ['-o', text], check=True)
+        subprocess.run(cc + ['--emit-bytecode', '-o', binary], check=True)
+
+        print(f'{"module":<24} {"size KiB":>10}')
+        for name, path in (('text', text), ('bytecode', binary)):
+            print(f'{name:<24} {os.path.getsize(path) / 1024:>10.1f}')
+        print()
+
+        opt = tool('vast-opt')
+        benchmarks = {
+            'text -> text'         : [opt, text],
+            'bytecode -> bytecode' : [opt, '--emit-bytecode', binary],
+            'text -> bytecode'     : [opt, '--emit-bytecode', text],
+            'bytecode -> text'     : [opt, binary],
+            'query text'           : [tool('vast-query'), '--show-symbols=functions', text],
+            'query bytecode'       : [tool('vast-query'), '--show-symbols=functions', binary],
+            # bytecode decodes only the queried function
+            'scope text'           : [tool('vast-query'), '--show-symbols=vars', '--scope=walk_0', text],
+            'scope bytecode'       : [tool('vast-query'), '--show-symbols=vars', '--scope=walk_0', binary],
+        }
+
+        print(f'{"benchmark":<24} {"min ms":>10} {"median ms":>10}')
+        for name, args in benchmarks.items():
+            times = measure(args, opts.runs)
+            print(f'{name:<24} {min(times):>10.1f} {statistics.median(times):>10.1f}')
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,86 @@
+# Copyright (c) 2022-present, Trail of Bits, Inc.
+
+# Compares default and compact (--compact-locations) source locations: size of
+# emitted modules, peak memory and wall time of vast-cc, on a generated
+# translation unit with many functions.
+#
+#   python3 bench/locations.py --bin-dir <build>/bin [--runs 5] [--functions 2000]
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+function = '''
+struct node_{0} {{ int value; const unsigned long weight; struct node_{0} *next; }};
+
+unsigned long walk_{0}(struct node_{0} *node, int limit) {{
+    unsigned long sum = 0;
+    int values[8] = {{ 0 }};
+    for (int i = 0; node && i < limit; ++i, node = node->next) {{
+        values[i % 8] += node->value;
+        sum += node->weight * (unsigned long)values[i % 8];
+    }}
+    if (sum > {0}u)
+        return sum - {0}u;
+    return sum;
+}}
+'''
+
+def generate(functions):
+    return ''.join(function.format(i) for i in range(functions))
+
+# wall times in ms and peak resident memory in KiB of each run
+def measure(args, runs):
+    times, peaks = [], []
+    for _ in range(runs):
+        start = time.perf_counter()
+        proc = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        _, status, usage = os.wait4(proc.pid, 0)
+        if status != 0:
+            raise subprocess.CalledProcessError(status, args)
+        times.append((time.perf_counter() - start) * 1000)
+        peaks.append(usage.ru_maxrss)
+    return times, peaks
+
+def main():
+    parser = argparse.ArgumentParser(description='default and compact locations')
+    parser.add_argument('--bin-dir', default='', help='directory with vast tools')
+    parser.add_argument('--runs', type=int, default=5)
+    parser.add_argument('--functions', type=int, default=2000,
+                        help='number of functions of the generated unit')
+    opts = parser.parse_args()
+
+    tool = lambda name: os.path.join(opts.bin_dir, name)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'input.c')
+        with open(src, 'w') as f:
+            f.write(generate(opts.functions))
+
+        cc = [tool('vast-cc'), '--ccopts', '-xc', '--from-source', src]
+        variants = {
+            'default' : [],
+            'compact' : ['--compact-locations'],
+        }
+
+        print(f'{"variant":<24} {"text KiB":>10} {"bytecode KiB":>12} '
+              f'{"median ms":>10} {"peak MiB":>10}')
+        for name, flags in variants.items():
+            text = os.path.join(tmp, name + '.mlir')
+            binary = os.path.join(tmp, name + '.vbc')
+            subprocess.run(cc + flags + ['--mlir-print-debuginfo', '-o', text], check=True)
+            subprocess.run(cc + flags + ['--emit-bytecode', '-o', binary], check=True)
+
+            times, peaks = measure(cc + flags + ['--emit-bytecode', '-o', binary], opts.runs)
+            print(f'{name:<24} {os.path.getsize(text) / 1024:>10.1f} '
+                  f'{os.path.getsize(binary) / 1024:>12.1f} '
+                  f'{statistics.median(times):>10.1f} {max(peaks) / 1024:>10.1f}')
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,71 @@
+# Copyright (c) 2022-present, Trail of Bits, Inc.
+
+# Compares lowering of high-level types in place, in a single walk over the
+# module, with lowering by the dialect conversion driver.
+#
+#   python3 bench/lower_types.py --bin-dir <build>/bin [--runs 10] [--functions 2000]
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+function = '''
+unsigned long sum_{0}(const int *values, unsigned long *weights, int size) {{
+    unsigned long sum = 0;
+    float scaled[4] = {{ 0.5f, 1.0f, 1.5f, 2.0f }};
+    for (int i = 0; i < size; ++i) {{
+        sum += (unsigned long)values[i] * weights[i] + (unsigned long)scaled[i % 4];
+    }}
+    return sum + {0}u;
+}}
+'''
+
+def generate(functions):
+    return ''.join(function.format(i) for i in range(functions))
+
+def measure(args, runs):
+    times = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        subprocess.run(args, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        times.append((time.perf_counter() - start) * 1000)
+    return times
+
+def main():
+    parser = argparse.ArgumentParser(description='in-place and conversion-driver type lowering')
+    parser.add_argument('--bin-dir', default='', help='directory with vast tools')
+    parser.add_argument('--runs', type=int, default=10)
+    parser.add_argument('--functions', type=int, default=2000,
+                        help='number of functions of the generated unit')
+    opts = parser.parse_args()
+
+    tool = lambda name: os.path.join(opts.bin_dir, name)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'input.c')
+        mod = os.path.join(tmp, 'input.mlir')
+        with open(src, 'w') as f:
+            f.write(generate(opts.functions))
+
+        subprocess.run([tool('vast-cc'), '--ccopts', '-xc', '--from-source', src, '-o', mod], check=True)
+
+        opt = tool('vast-opt')
+        benchmarks = {
+            'parse only'        : [opt, mod],
+            'in place'          : [opt, '--vast-hl-lower-types', mod],
+            'conversion driver' : [opt, '--vast-hl-lower-types=conversion-driver=true', mod],
+        }
+
+        print(f'{"benchmark":<24} {"min ms":>10} {"median ms":>10}')
+        for name, args in benchmarks.items():
+            times = measure(args, opts.runs)
+            print(f'{name:<24} {min(times):>10.1f} {statistics.median(times):>10.1f}')
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,65 @@
+# Copyright (c) 2022-present, Trail of Bits, Inc.
+
+# Measures wall time of short runs of vast tools, which is dominated by their
+# startup (registration and loading of dialects, option parsing).
+#
+#   python3 bench/startup.py --bin-dir <build>/bin [--runs 20] [--max-ms 200]
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+source = '''
+struct point { int x, y; };
+int norm(struct point p) { return p.x * p.x + p.y * p.y; }
+int main(void) { struct point p = { 3, 4 }; return norm(p); }
+'''
+
+def measure(args, runs):
+    times = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        subprocess.run(args, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        times.append((time.perf_counter() - start) * 1000)
+    return times
+
+def main():
+    parser = argparse.ArgumentParser(description='startup time of vast tools')
+    parser.add_argument('--bin-dir', default='', help='directory with vast tools')
+    parser.add_argument('--runs', type=int, default=20)
+    parser.add_argument('--max-ms', type=float, default=None,
+                        help='fail if a median exceeds the limit')
+    opts = parser.parse_args()
+
+    tool = lambda name: os.path.join(opts.bin_dir, name)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'input.c')
+        mod = os.path.join(tmp, 'input.mlir')
+        with open(src, 'w') as f:
+            f.write(source)
+
+        subprocess.run([tool('vast-cc'), '--ccopts', '-xc', '--from-source', src, '-o', mod], check=True)
+
+        benchmarks = {
+            'vast-cc --from-source' : [tool('vast-cc'), '--ccopts', '-xc', '--from-source', src],
+            'vast-opt'              : [tool('vast-opt'), mod],
+            'vast-query'            : [tool('vast-query'), '--show-symbols=functions', mod],
+        }
+
+        failed = False
+        print(f'{"benchmark":<24} {"min ms":>10} {"median ms":>10}')
+        for name, args in benchmarks.items():
+            times = measure(args, opts.runs)
+            median = statistics.median(times)
+            print(f'{name:<24} {min(times):>10.1f} {median:>10.1f}')
+            failed |= opts.max_ms is not None and median > opts.max_ms
+
+    return 1 if failed else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,134 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/OwningOpRef.h>
+#include <mlir/Support/LogicalResult.h>
+VAST_UNRELAX_WARNINGS
+
+#include <memory>
+#include <vector>
+
+namespace vast::bytecode
+{
+    //
+    // VAST bytecode
+    //
+    // Binary encoding of modules, that is faster to load and store than the
+    // textual form. A module is stored as:
+    //
+    //   magic, version
+    //   strings    -- deduplicated strings referred to by index
+    //   types      -- table of types, each entry is decoded on first use
+    //   attributes -- table of attributes (including locations)
+    //   index      -- symbols defined at the top level of a module
+    //   ir         -- operations in preorder
+    //   bodies     -- operations of the index, each encoded on its own
+    //
+    // Types and attributes of dialects with `BytecodeDialectInterface` are
+    // stored in their compact encodings, the others in their textual form.
+    // Values are numbered in the order of their definitions, restarting in
+    // regions of operations isolated from above.
+    //
+    // Top-level symbols of a module with non-empty regions (function
+    // definitions, initialized globals, records) that do not refer to other
+    // values of the module are moved out of the ir section to the bodies
+    // section. The index maps their names to byte ranges of their encodings,
+    // so that they can be decoded independently of each other.
+    //
+    using owning_module_ref = mlir::OwningOpRef< mlir::ModuleOp >;
+
+    static constexpr llvm::StringLiteral magic = "VASTBC";
+
+    static constexpr std::uint64_t version = 2;
+
+    bool is_bytecode(llvm::StringRef buffer);
+
+    mlir::LogicalResult write_bytecode(mlir::Operation *op, llvm::raw_ostream &os);
+
+    // The buffer has to outlive the call only, the module does not refer to it.
+    // Errors are reported to diagnostic handlers of the context.
+    owning_module_ref read_bytecode(llvm::StringRef buffer, mlir::MLIRContext *mctx);
+
+    // Reads a module either from bytecode or from the textual form.
+    owning_module_ref load_module(llvm::SourceMgr &mgr, mlir::MLIRContext *mctx);
+
+    owning_module_ref load_module(llvm::StringRef path, mlir::MLIRContext *mctx);
+
+    namespace detail
+    {
+        struct module_reader;
+    } // namespace detail
+
+    //
+    // Lazily loaded module
+    //
+    // Opening the module decodes only the operations of the ir section, i.e.,
+    // declarations shared by the whole module. Symbols of the index are
+    // materialized on demand and inserted at their original positions.
+    //
+    struct lazy_module {
+        struct index_entry {
+            llvm::StringRef symbol;
+            // name of the operation defining the symbol, e.g., `hl.func`
+            llvm::StringRef operation;
+            // number of shared operations that precede the symbol
+            std::uint64_t position;
+            llvm::StringRef body;
+            mlir::Operation *op = nullptr;
+
+            bool materialized() const { return op; }
+        };
+
+        ~lazy_module();
+
+        // Files are memory-mapped, the buffer is kept until the module is
+        // released. Errors are reported to diagnostic handlers of the context.
+        static std::unique_ptr< lazy_module > open(
+            std::unique_ptr< llvm::MemoryBuffer > buffer, mlir::MLIRContext *mctx
+        );
+
+        static std::unique_ptr< lazy_module > open(llvm::StringRef path, mlir::MLIRContext *mctx);
+
+        mlir::ModuleOp module() const { return mod.get(); }
+
+        const std::vector< index_entry > &index() const { return entries; }
+
+        // Materializes all symbols of the given name, unknown names are
+        // ignored, their operations may be among the shared ones.
+        mlir::LogicalResult materialize(llvm::StringRef symbol);
+
+        mlir::LogicalResult materialize_all();
+
+        // The module does not refer to the buffer, it outlives the lazy module.
+        owning_module_ref release() { return std::move(mod); }
+
+      private:
+        lazy_module(std::unique_ptr< llvm::MemoryBuffer > buffer, mlir::MLIRContext *mctx);
+
+        mlir::LogicalResult init();
+
+        mlir::LogicalResult materialize(index_entry &entry);
+
+        std::unique_ptr< llvm::MemoryBuffer > buffer;
+        std::unique_ptr< detail::module_reader > reader;
+
+        owning_module_ref mod;
+        std::vector< mlir::Operation * > shared;
+
+        std::vector< index_entry > entries;
+        llvm::StringMap< llvm::SmallVector< std::size_t, 1 > > by_symbol;
+    };
+
+} // namespace vast::bytecode
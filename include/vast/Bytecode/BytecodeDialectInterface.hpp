@@ -0,0 +1,112 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/StringRef.h>
+#include <mlir/IR/Attributes.h>
+#include <mlir/IR/DialectInterface.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/Types.h>
+#include <mlir/Support/LogicalResult.h>
+VAST_UNRELAX_WARNINGS
+
+#include <cstdint>
+
+namespace vast::bytecode
+{
+    //
+    // Encoders of dialect types and attributes
+    //
+    // Types and attributes are stored once per module in tables, entities refer
+    // to them by indices. Hence `write_type` and `write_attribute` store just
+    // an index of the nested entity.
+    //
+    struct dialect_writer {
+        virtual ~dialect_writer() = default;
+
+        virtual void write_varint(std::uint64_t value) = 0;
+        virtual void write_signed_varint(std::int64_t value) = 0;
+        virtual void write_apint(const llvm::APInt &value) = 0;
+        virtual void write_string(llvm::StringRef value) = 0;
+
+        virtual void write_type(mlir::Type type) = 0;
+        virtual void write_attribute(mlir::Attribute attr) = 0;
+
+        void write_bool(bool value) { write_varint(value ? 1 : 0); }
+    };
+
+    struct dialect_reader {
+        virtual ~dialect_reader() = default;
+
+        virtual mlir::MLIRContext *context() const = 0;
+
+        virtual mlir::LogicalResult read_varint(std::uint64_t &value) = 0;
+        virtual mlir::LogicalResult read_signed_varint(std::int64_t &value) = 0;
+        virtual mlir::LogicalResult read_apint(llvm::APInt &value) = 0;
+        // the string is owned by the reader, and valid as long as it is
+        virtual mlir::LogicalResult read_string(llvm::StringRef &value) = 0;
+
+        virtual mlir::LogicalResult read_type(mlir::Type &type) = 0;
+        virtual mlir::LogicalResult read_attribute(mlir::Attribute &attr) = 0;
+
+        mlir::LogicalResult read_bool(bool &value) {
+            std::uint64_t raw;
+            if (mlir::failed(read_varint(raw)) || raw > 1) {
+                return mlir::failure();
+            }
+            value = raw;
+            return mlir::success();
+        }
+
+        template< typename T >
+        mlir::LogicalResult read_varint(T &value) {
+            std::uint64_t raw;
+            if (mlir::failed(read_varint(raw)) || raw != std::uint64_t(T(raw))) {
+                return mlir::failure();
+            }
+            value = T(raw);
+            return mlir::success();
+        }
+
+        // Reads a type of the expected kind, a null type reads as a null `T`.
+        template< typename T >
+        mlir::LogicalResult read_optional_type(T &type) {
+            mlir::Type raw;
+            if (mlir::failed(read_type(raw))) {
+                return mlir::failure();
+            }
+            type = raw.dyn_cast_or_null< T >();
+            return mlir::success(!raw || type);
+        }
+    };
+
+    //
+    // BytecodeDialectInterface
+    //
+    // Compact encodings of types and attributes of a dialect in the VAST
+    // bytecode (see `vast/Bytecode/Bytecode.hpp`). Entities that the dialect
+    // does not encode (write fails) are stored in their textual form.
+    //
+    struct BytecodeDialectInterface
+        : mlir::DialectInterface::Base< BytecodeDialectInterface >
+    {
+        BytecodeDialectInterface(mlir::Dialect *dialect) : Base(dialect) {}
+
+        virtual mlir::LogicalResult write_type(mlir::Type, dialect_writer &) const {
+            return mlir::failure();
+        }
+
+        virtual mlir::Type read_type(dialect_reader &) const { return {}; }
+
+        virtual mlir::LogicalResult write_attribute(mlir::Attribute, dialect_writer &) const {
+            return mlir::failure();
+        }
+
+        virtual mlir::Attribute read_attribute(dialect_reader &) const { return {}; }
+    };
+
+} // namespace vast::bytecode
@@ -5,7 +5,9 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/Dialect/DLTI/DLTI.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/MLIRContext.h"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
@@ -28,4 +30,14 @@ namespace vast {
         mctx.appendDialectRegistry(registry);
     }
 
+    // Dialects of modules emitted from clang ast (the builtin dialect is
+    // always loaded).
+    inline void loadCodeGenDialects(MContext &mctx) {
+        mctx.loadDialect<
+            vast::hl::HighLevelDialect,
+            vast::meta::MetaDialect,
+            mlir::DLTIDialect
+        >();
+    }
+
 } // namespace vast
@@ -0,0 +1,108 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/Region.h>
+#include <mlir/IR/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // Trailing scopes
+    //
+    // A scope at the end of a region ends together with the region, hence its
+    // body can be inlined into the region. Operations are moved, each of them
+    // once, when its own scope is inlined.
+    //
+    inline void splice_trailing_scopes(mlir::Region &region) {
+        while (!region.empty() && !region.back().empty()) {
+            auto scope = mlir::dyn_cast< ScopeOp >(region.back().back());
+            if (!scope) {
+                return;
+            }
+
+            auto &tail = region.back();
+            auto &body = scope.getBody();
+            if (!body.empty()) {
+                // the entry block of the scope continues the tail block, other
+                // blocks of the scope follow it
+                auto &entry = body.front();
+                tail.getOperations().splice(mlir::Block::iterator(scope), entry.getOperations());
+
+                auto &blocks = region.getBlocks();
+                blocks.splice(blocks.end(), body.getBlocks(), std::next(body.begin()), body.end());
+            }
+
+            scope.erase();
+        }
+    }
+
+    // Inlines trailing scopes of all regions nested in the operation, except
+    // regions of scopes themselves, that delimit lifetimes of their variables.
+    inline void splice_trailing_scopes(mlir::Operation *op) {
+        op->walk([] (mlir::Operation *nested) {
+            if (mlir::isa< ScopeOp >(nested)) {
+                return;
+            }
+
+            for (auto &region : nested->getRegions()) {
+                splice_trailing_scopes(region);
+            }
+        });
+    }
+
+    // Functions are independent, hence they are processed in parallel. They
+    // need not be at the top level (e.g., in `hl.translation_unit`).
+    inline void splice_trailing_scopes(mlir::ModuleOp mod) {
+        std::vector< mlir::Operation * > functions;
+        mod->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *op) {
+            if (mlir::isa< FuncOp >(op)) {
+                functions.push_back(op);
+                return mlir::WalkResult::skip();
+            }
+            return mlir::WalkResult::advance();
+        });
+
+        mlir::parallelForEach(mod.getContext(), functions, [] (mlir::Operation *fn) {
+            splice_trailing_scopes(fn);
+        });
+    }
+
+    //
+    // Constant globals
+    //
+    // The constant that initializes a variable outside of functions, if the
+    // initializer consists only of it. Such variables are lowered to globals
+    // with an initializer instead of stores.
+    //
+    inline Operation *constant_global_initializer(VarDeclOp var) {
+        if (var->getParentOfType< mlir::FunctionOpInterface >()) {
+            return nullptr;
+        }
+
+        auto &init = var.getInitializer();
+        if (!init.hasOneBlock() || init.front().getOperations().size() != 2) {
+            return nullptr;
+        }
+
+        auto yield = mlir::dyn_cast< ValueYieldOp >(init.front().back());
+        if (!yield) {
+            return nullptr;
+        }
+
+        auto value = yield.getResult().getDefiningOp();
+        return mlir::isa_and_nonnull< ConstantOp, DenseConstantOp >(value) ? value : nullptr;
+    }
+
+} // namespace vast::hl
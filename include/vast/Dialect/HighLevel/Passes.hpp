@@ -25,6 +25,8 @@ namespace vast::hl
 
     std::unique_ptr< mlir::Pass > createHLToSCFPass();
 
+    std::unique_ptr< mlir::Pass > createHLSpliceTrailingScopesPass();
+
     std::unique_ptr< mlir::Pass > createLLVMDumpPass();
 
     std::unique_ptr< mlir::Pass > createExportFnInfoPass();
@@ -4,5 +4,51 @@
 
 #include "vast/Dialect/Meta/MetaDialect.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/Location.h>
+VAST_UNRELAX_WARNINGS
+
+#include <optional>
+#include <string>
+#include <vector>
+
 #define GET_ATTRDEF_CLASSES
 #include "vast/Dialect/Meta/MetaAttributes.h.inc"
+
+namespace vast::meta
+{
+    //
+    // Compact source locations
+    //
+    // A compact location is a file location of line zero, whose column is the
+    // byte offset of the location in the file. Source lines are numbered from
+    // one, hence the line distinguishes compact locations from others. Lines
+    // and columns are resolved from the source file only when queried.
+    //
+    mlir::Location make_offset_location(mlir::StringAttr file, unsigned offset);
+
+    std::optional< unsigned > get_offset(mlir::Location loc);
+
+    struct resolved_location {
+        std::string file;
+        unsigned line, column;
+    };
+
+    //
+    // offset_resolver
+    //
+    // Resolves compact locations to lines and columns. Line offsets of each
+    // file are read once per resolver.
+    //
+    struct offset_resolver {
+        std::optional< resolved_location > resolve(mlir::Location loc);
+
+    private:
+        // offsets of line beginnings, empty if the file is not readable
+        const std::vector< unsigned > &lines(llvm::StringRef file);
+
+        llvm::StringMap< std::vector< unsigned > > files;
+    };
+
+} // namespace vast::meta
@@ -0,0 +1,25 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Support/LogicalResult.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::hl
+{
+    //
+    // Batch translation
+    //
+    // Lifts every translation unit of a compilation database (`compile_commands.json`)
+    // in a single vast-cc process. Units are processed by a pool of workers, each
+    // owning its own mlir context, the largest units are scheduled first. One module
+    // is written per unit, failing units are reported and do not stop the batch.
+    //
+    bool is_batch_translation(int argc, char **argv);
+
+    mlir::LogicalResult run_batch_translation(int argc, char **argv);
+
+} // namespace vast::hl
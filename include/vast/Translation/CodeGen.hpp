@@ -12,7 +12,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/MLIRContext.h>
-#include <mlir/InitAllDialects.h>
+#include <mlir/IR/Threading.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
@@ -21,20 +21,25 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Translation/CodeGenFallBackVisitor.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/Meta/MetaDialect.hpp"
 #include "vast/Dialect/Dialects.hpp"
 
 #include "vast/Translation/DataLayout.hpp"
 #include "vast/Translation/CodeGenMeta.hpp"
+#include "vast/Translation/CodeGenOptions.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 namespace vast::hl
 {
     namespace detail {
+        // Loads only dialects the codegen emits, other dialects registered
+        // by tools are loaded on demand.
         static inline MContext& codegen_context_setup(MContext &ctx) {
-            mlir::registerAllDialects(ctx);
-            vast::registerAllDialects(ctx);
-
-            ctx.loadAllAvailableDialects();
+            vast::loadCodeGenDialects(ctx);
             return ctx;
         };
 
@@ -50,8 +55,8 @@ namespace vast::hl
     {
         using MetaGenerator = typename CodeGenVisitor::MetaGeneratorType;
 
-        CodeGenBase(MContext *mctx, MetaGenerator &meta)
-            : _mctx(mctx), _meta(meta), _cgctx(nullptr), _module(nullptr)
+        CodeGenBase(MContext *mctx, MetaGenerator &meta, codegen_options opts = {})
+            : _mctx(mctx), _meta(meta), _opts(opts), _cgctx(nullptr), _module(nullptr)
         {
             detail::codegen_context_setup(*_mctx);
         }
@@ -70,36 +75,30 @@ namespace vast::hl
 
         void append_to_module(clang::Decl *decl) { append_impl(decl); }
 
-        void append_to_module(clang::Stmt *stmt) { append_impl(stmt); }
+        OwningModuleRef freeze() {
+            emit_deferred_bodies();
+            splice_trailing_scopes(_module.get());
+            emit_data_layout(*_mctx, _module, _cgctx->data_layout());
+            if (_opts.incremental) {
+                _opts.incremental->finish();
+            }
 
-        void append_to_module(clang::Expr *expr) { append_impl(expr); }
+            if (_opts.type_stats) {
+                *_opts.type_stats += _cgctx->type_stats;
+            }
 
-        void append_to_module(clang::Type *type) { append_impl(type); }
+            if (_opts.unsupported) {
+                *_opts.unsupported += _cgctx->unsupported;
+            }
+
+            for (auto op : _cgctx->released_bodies) {
+                op->erase();
+            }
+            _cgctx->released_bodies.clear();
 
-        OwningModuleRef freeze() {
-            emit_data_layout(*_mctx, _module, _cgctx->data_layout());
             return std::move(_module);
         }
 
-        template< typename From, typename Symbol >
-        using ScopedSymbolTable = llvm::ScopedHashTableScope< From, Symbol >;
-
-        using TypeDefsScope      = ScopedSymbolTable< const clang::TypedefDecl *, TypeDefOp >;
-        using TypeDeclsScope     = ScopedSymbolTable< const clang::TypeDecl *, TypeDeclOp >;
-        using EnumDeclsScope     = ScopedSymbolTable< const clang::EnumDecl *, EnumDeclOp >;
-        using EnumConstantsScope = ScopedSymbolTable< const clang::EnumConstantDecl *, EnumConstantOp >;
-        using FunctionsScope     = ScopedSymbolTable< const clang::FunctionDecl *, FuncOp >;
-        using VariablesScope     = ScopedSymbolTable< const clang::VarDecl *, Value >;
-
-        struct CodegenScope {
-            TypeDefsScope      typedefs;
-            TypeDeclsScope     typedecls;
-            EnumDeclsScope     enumdecls;
-            EnumConstantsScope enumconsts;
-            FunctionsScope     funcdecls;
-            VariablesScope     globs;
-        };
-
     private:
 
         void setup_codegen(AContext &actx) {
@@ -111,16 +110,70 @@ namespace vast::hl
 
             _cgctx = std::make_unique< CodeGenContext >(*_mctx, actx, _module);
 
-            _scope = std::unique_ptr< CodegenScope >( new CodegenScope{
-                .typedefs   = _cgctx->typedefs,
-                .typedecls  = _cgctx->typedecls,
-                .enumdecls  = _cgctx->enumdecls,
-                .enumconsts = _cgctx->enumconsts,
-                .funcdecls  = _cgctx->funcdecls,
-                .globs      = _cgctx->vars
+            _visitor = std::make_unique< CodeGenVisitor >(*_cgctx, _meta);
+
+            if (_opts.incremental) {
+                _opts.incremental->start();
+                _cgctx->incremental = _opts.incremental;
+            }
+
+            _cgctx->decl_filter = _opts.decl_filter;
+            _cgctx->signatures_only = _opts.signatures_only;
+            _cgctx->fold_constants  = _opts.fold_constants;
+            _cgctx->type_cache      = _opts.type_cache;
+
+            // filtered declarations are emitted lazily to the module, that
+            // workers are not allowed to modify
+            _cgctx->defer_function_bodies = _opts.parallel_bodies
+                && !_opts.incremental
+                && !_opts.decl_filter
+                && !_opts.stream_definition;
+        }
+
+        //
+        // Parallel emission of function bodies
+        //
+        // Each worker owns its builder and context, that declares local symbols
+        // and falls back to the module context for global ones. Deferred bodies
+        // do not add symbols to the module, so the order of their emission does
+        // not affect the result.
+        //
+        using SynchronizedMeta = SynchronizedMetaGenerator< MetaGenerator >;
+        using WorkerVisitor    = typename CodeGenVisitor::template rebind_meta< SynchronizedMeta >;
+
+        void emit_deferred_bodies() {
+            auto &bodies = _cgctx->deferred_bodies;
+            if (bodies.empty())
+                return;
+
+            std::mutex actx_mutex;
+            SynchronizedMeta meta(_meta, actx_mutex);
+
+            auto workers = std::min< size_t >(_mctx->getNumThreads(), bodies.size());
+            std::vector< std::unique_ptr< CodeGenContext > > contexts(workers);
+            std::atomic_size_t next = 0;
+
+            mlir::parallelFor(_mctx, 0, workers, [&] (size_t worker) {
+                auto &ctx = contexts[worker];
+                ctx = std::make_unique< CodeGenContext >(*_cgctx, actx_mutex);
+
+                WorkerVisitor visitor(*ctx, meta);
+                for (auto i = next++; i < bodies.size(); i = next++) {
+                    auto [fn, decl] = bodies[i];
+                    visitor.emit_function_body(fn, decl);
+                }
             });
 
-            _visitor = std::make_unique< CodeGenVisitor >(*_cgctx, _meta);
+            for (const auto &ctx : contexts) {
+                for (const auto &[type, entry] : ctx->data_layout().entries) {
+                    _cgctx->data_layout().entries.try_emplace(type, entry);
+                }
+
+                _cgctx->type_stats  += ctx->type_stats;
+                _cgctx->unsupported += ctx->unsupported;
+            }
+
+            bodies.clear();
         }
 
         template< typename AST >
@@ -130,23 +183,73 @@ namespace vast::hl
         }
 
         static bool process_root_decl(void * context, const clang::Decl *decl) {
-            CodeGenVisitor &visitor = *static_cast<CodeGenVisitor*>(context);
-            return visitor.Visit(decl), true;
+            auto &self = *static_cast< CodeGenBase * >(context);
+            return self.process_top_level(decl, *self._visitor), true;
         }
 
-        void process(clang::ASTUnit *unit, CodeGenVisitor &visitor) {
-            unit->visitLocalTopLevelDecls(&visitor, process_root_decl);
+        void process(clang::ASTUnit *unit, CodeGenVisitor &/* visitor */) {
+            unit->visitLocalTopLevelDecls(this, process_root_decl);
         }
 
         void process(clang::Decl *decl, CodeGenVisitor &visitor) {
-            visitor.Visit(decl);
+            if (_opts.decl_filter && clang::isa< clang::TranslationUnitDecl >(decl)) {
+                for (auto child : clang::cast< clang::TranslationUnitDecl >(decl)->decls()) {
+                    process_top_level(child, visitor);
+                }
+            } else {
+                process_top_level(decl, visitor);
+            }
+        }
+
+        void process_top_level(const clang::Decl *decl, CodeGenVisitor &visitor) {
+            if (!_cgctx->passes_filter(decl)) {
+                return;
+            }
+
+            auto &body = _module->getBodyRegion().front();
+            auto last  = body.empty() ? nullptr : &body.back();
+
+            auto op = visitor.Visit(decl);
+
+            // lazily emitted declarations precede the declaration that references them
+            auto &lazy = _cgctx->lazy_declarations;
+            auto first = last ? last->getNextNode() : (body.empty() ? nullptr : &body.front());
+            while (first && lazy.count(first)) {
+                first = first->getNextNode();
+            }
+
+            if (first) {
+                for (auto op : lazy) {
+                    op->moveBefore(first);
+                }
+            }
+
+            lazy.clear();
+
+            if (_opts.stream_definition) {
+                stream_definition(op);
+            }
+        }
+
+        void stream_definition(Operation *op) {
+            auto fn = mlir::dyn_cast_or_null< FuncOp >(op);
+            if (!fn || fn.empty()) {
+                return;
+            }
+
+            splice_trailing_scopes(fn);
+            _opts.stream_definition(fn);
+
+            mlir::Region empty;
+            fn.getBody().takeBody(empty);
+            _cgctx->released_bodies.insert(fn);
         }
 
         MContext *_mctx;
         MetaGenerator &_meta;
+        codegen_options _opts;
 
         std::unique_ptr< CodeGenContext > _cgctx;
-        std::unique_ptr< CodegenScope >   _scope;
         std::unique_ptr< CodeGenVisitor > _visitor;
 
         OwningModuleRef _module;
@@ -158,6 +261,13 @@ namespace vast::hl
         DefaultFallBackVisitorMixin
     >;
 
+    // Emits placeholders of unsupported nodes instead of aborting.
+    template< typename Derived >
+    using TolerantCodeGenVisitorConfig = CodeGenFallBackVisitorMixin< Derived,
+        DefaultCodeGenVisitorMixin,
+        UnsupportedFallBackVisitorMixin
+    >;
+
     //
     // DefaultCodeGen
     //
@@ -175,8 +285,8 @@ namespace vast::hl
 
         using Base = CodeGenBase< Visitor >;
 
-        DefaultCodeGen(AContext *actx, MContext *mctx)
-            : meta(actx, mctx), codegen(mctx, meta)
+        DefaultCodeGen(AContext *actx, MContext *mctx, codegen_options opts = {})
+            : meta(actx, mctx), codegen(mctx, meta, opts)
         {}
 
         OwningModuleRef emit_module(clang::ASTUnit *unit) {
@@ -187,10 +297,16 @@ namespace vast::hl
             return codegen.emit_module(decl);
         }
 
+        void append_to_module(clang::Decl *decl) { codegen.append_to_module(decl); }
+
+        OwningModuleRef freeze() { return codegen.freeze(); }
+
         MetaGenerator meta;
         CodeGenBase< Visitor > codegen;
     };
 
     using CodeGenWithMetaIDs = DefaultCodeGen< DefaultCodeGenVisitorConfig, IDMetaGenerator >;
 
+    using CodeGenWithCompactLocations = DefaultCodeGen< DefaultCodeGenVisitorConfig, CompactMetaGenerator >;
+
 } // namespace vast::hl
@@ -0,0 +1,113 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/DeclGroup.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/CodeGenOptions.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+
+namespace vast::hl
+{
+    //
+    // CodeGenConsumer
+    //
+    // Emits top-level declarations as soon as clang parses them, so code
+    // generation overlaps with parsing instead of waiting for a full ASTUnit.
+    // The resulting module is stored to `mod` once the translation unit ends.
+    //
+    // Nothing is emitted after clang reports an error, as invalid declarations
+    // and expressions are not supported by the codegen. The unit then has no
+    // module.
+    //
+    template< typename CodeGen >
+    struct CodeGenConsumer : clang::ASTConsumer
+    {
+        CodeGenConsumer(MContext &mctx, OwningModuleRef &mod, codegen_options opts)
+            : mctx(mctx), mod(mod), opts(opts)
+        {}
+
+        void Initialize(AContext &actx) override {
+            diags = &actx.getDiagnostics();
+            codegen.emplace(&actx, &mctx, opts);
+        }
+
+        bool HandleTopLevelDecl(clang::DeclGroupRef decls) override {
+            // keep parsing to report all errors of the unit
+            if (diags->hasErrorOccurred()) {
+                return true;
+            }
+
+            for (auto decl : decls) {
+                codegen->append_to_module(decl);
+            }
+
+            return true;
+        }
+
+        void HandleTranslationUnit(AContext &actx) override {
+            if (diags->hasErrorOccurred()) {
+                mod = nullptr;
+                return;
+            }
+
+            mod = codegen->freeze();
+        }
+
+        // Consulted by the parser when function bodies are skipped, see
+        // `CodeGenAction::CreateASTConsumer`. Skipped bodies would not be
+        // emitted anyway.
+        bool shouldSkipFunctionBody(clang::Decl *decl) override {
+            return opts.skips_function_body(decl);
+        }
+
+    private:
+        MContext &mctx;
+        OwningModuleRef &mod;
+        codegen_options opts;
+
+        clang::DiagnosticsEngine *diags = nullptr;
+        std::optional< CodeGen > codegen;
+    };
+
+    //
+    // CodeGenAction
+    //
+    // Frontend action that drives `CodeGenConsumer`. Unlike `ASTUnit`, it does
+    // not keep stored diagnostics nor builds a preamble.
+    //
+    template< typename CodeGen >
+    struct CodeGenAction : clang::ASTFrontendAction
+    {
+        CodeGenAction(MContext &mctx, OwningModuleRef &mod, codegen_options opts = {})
+            : mctx(mctx), mod(mod), opts(opts)
+        {}
+
+    protected:
+        std::unique_ptr< clang::ASTConsumer > CreateASTConsumer(
+            clang::CompilerInstance &ci, llvm::StringRef /* file */
+        ) override {
+            if (opts.decl_filter || opts.signatures_only) {
+                ci.getFrontendOpts().SkipFunctionBodies = true;
+            }
+
+            return std::make_unique< CodeGenConsumer< CodeGen > >(mctx, mod, opts);
+        }
+
+    private:
+        MContext &mctx;
+        OwningModuleRef &mod;
+        codegen_options opts;
+    };
+
+} // namespace vast::hl
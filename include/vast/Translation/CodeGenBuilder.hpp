@@ -200,10 +200,9 @@ namespace vast::hl {
         }
 
         auto make_region_builder(const clang::Stmt *stmt) {
-            return [stmt, this](auto &bld, auto) {
+            // trailing scopes are inlined when the module is frozen
+            return [stmt, this](auto &, auto) {
                 if (stmt) visit(stmt);
-                // TODO let other pass remove trailing scopes?
-                splice_trailing_scopes(*bld.getBlock()->getParent());
             };
         }
 
@@ -245,8 +244,13 @@ namespace vast::hl {
             return create< ConstantOp >(loc, ty.cast< ArrayType >(), value);
         }
 
+        mlir::Value constant(mlir::Location loc, mlir::Type ty, mlir::DenseElementsAttr value) {
+            VAST_CHECK(ty.isa< ArrayType >(), "dense constant must have array type");
+            return create< DenseConstantOp >(loc, ty, value);
+        }
+
         FuncOp declare(const clang::FunctionDecl *decl, auto vast_decl_builder) {
-            return declare< FuncOp >(context().funcdecls, decl, vast_decl_builder);
+            return declare< FuncOp >(context().funcdecls, decl->getCanonicalDecl(), vast_decl_builder);
         }
 
         Value declare(const clang::ParmVarDecl *decl, auto vast_value) {
@@ -6,7 +6,10 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
-#include <llvm/ADT/ScopedHashTable.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/Twine.h>
 #include <mlir/IR/MLIRContext.h>
 #include <mlir/IR/Value.h>
 #include <mlir/Support/LogicalResult.h>
@@ -17,13 +20,25 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Util/Functions.hpp"
-#include "vast/Util/ScopeTable.hpp"
 #include "vast/Util/Common.hpp"
 
+#include "vast/Translation/CodeGenDeclTable.hpp"
+#include "vast/Translation/CodeGenIncremental.hpp"
+#include "vast/Translation/CodeGenOptions.hpp"
+
+#include <functional>
+#include <mutex>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace vast::hl
 {
+    // Clang types are visited either as type pointers, that take qualifiers
+    // from the desugared type, or as qualified types. Both are translated
+    // differently, as well as lvalues of them.
+    enum class type_form : unsigned { type, qualified_type, lvalue };
+
     struct CodeGenContext {
         MContext &mctx;
         AContext &actx;
@@ -37,80 +52,234 @@ namespace vast::hl
             , mod(mod)
         {}
 
-        using VarTable = ScopedValueTable< const clang::VarDecl *, Value >;
-        VarTable vars;
+        // Context of a worker that emits function bodies in parallel. Symbols of
+        // the parent context are visible, new ones are declared only in the worker.
+        // Queries of clang contexts are serialized by `actx_mutex`.
+        CodeGenContext(CodeGenContext &parent, std::mutex &actx_mutex)
+            : mctx(parent.mctx)
+            , actx(parent.actx)
+            , mod(parent.mod)
+            , parent(&parent)
+            , actx_mutex(&actx_mutex)
+        {
+            symbols.parent = &parent.symbols;
+
+            fold_constants = parent.fold_constants;
+            type_cache     = parent.type_cache;
+        }
+
+        const CodeGenContext *parent = nullptr;
+        std::mutex *actx_mutex = nullptr;
+
+        //
+        // Symbols
+        //
+        // Declarations of all kinds share a single table, accessed by typed
+        // views. Variables and labels are scoped by function bodies, other
+        // symbols are visible in the whole module.
+        //
+        decl_table symbols;
+
+        using VarTable = decl_table::view< clang::VarDecl, Value, true >;
+        VarTable vars{ symbols };
 
-        using TypeDefTable = ScopedValueTable< const clang::TypedefDecl *, TypeDefOp >;
-        TypeDefTable typedefs;
+        using TypeDefTable = decl_table::view< clang::TypedefDecl, TypeDefOp >;
+        TypeDefTable typedefs{ symbols };
 
-        using TypeDeclTable = ScopedValueTable< const clang::TypeDecl *, TypeDeclOp >;
-        TypeDeclTable typedecls;
+        using TypeDeclTable = decl_table::view< clang::TypeDecl, TypeDeclOp >;
+        TypeDeclTable typedecls{ symbols };
 
-        using FuncDeclTable = ScopedValueTable< const clang::FunctionDecl *, FuncOp >;
-        FuncDeclTable funcdecls;
+        using FuncDeclTable = decl_table::view< clang::FunctionDecl, FuncOp >;
+        FuncDeclTable funcdecls{ symbols };
 
-        using EnumDecls = ScopedValueTable< const clang::EnumDecl *, EnumDeclOp >;
-        EnumDecls enumdecls;
+        using EnumDecls = decl_table::view< clang::EnumDecl, EnumDeclOp >;
+        EnumDecls enumdecls{ symbols };
 
-        using EnumConstants = ScopedValueTable< const clang::EnumConstantDecl *, EnumConstantOp >;
-        EnumConstants enumconsts;
+        using EnumConstants = decl_table::view< clang::EnumConstantDecl, EnumConstantOp >;
+        EnumConstants enumconsts{ symbols };
 
-        using LabelTable = ScopedValueTable< const clang::LabelDecl*, LabelDeclOp >;
-        LabelTable labels;
+        using LabelTable = decl_table::view< clang::LabelDecl, LabelDeclOp, true >;
+        LabelTable labels{ symbols };
 
         size_t anonymous_count = 0;
-        llvm::DenseMap< const clang::TagDecl *, std::string > tag_names;
 
-        std::string get_decl_name(const clang::NamedDecl *decl) {
-            if (decl->getIdentifier())
-                return decl->getName().str();
-            return "anonymous[" + std::to_string(decl->getID()) + "]";
+        // Definitions whose bodies are emitted after all top-level declarations,
+        // see `CodeGenBase::emit_deferred_bodies`.
+        bool defer_function_bodies = false;
+        std::vector< std::pair< FuncOp, const clang::FunctionDecl * > > deferred_bodies;
+
+        // Bodies of unchanged definitions are reused from the previous emission,
+        // see `CodeGenIncremental.hpp`.
+        incremental_state *incremental = nullptr;
+
+        // Filter of declarations, see `codegen_options::decl_filter`.
+        std::function< bool (const clang::Decl *) > decl_filter;
+
+        bool passes_filter(const clang::Decl *decl) const {
+            return !decl_filter || decl_filter(decl);
         }
 
-        std::string get_namespaced_for_decl_name(const clang::TagDecl *decl) {
-            // gather contexts
-            std::vector< const clang::DeclContext * > dctxs;
-            for (const auto *dctx = decl->getDeclContext(); dctx; dctx = dctx->getParent()) {
-                dctxs.push_back(dctx);
+        // Filtered declarations that were emitted on their first reference, and
+        // operations made for them since the last top-level declaration.
+        llvm::DenseSet< const clang::Decl * > referenced_decls;
+        llvm::SetVector< Operation * > lazy_declarations;
+
+        // Functions whose bodies were streamed out of the module, see
+        // `codegen_options::stream_definition`.
+        llvm::DenseSet< Operation * > released_bodies;
+
+        // Left operands of chains of expressions that were emitted before their
+        // users, see `CodeGenStmtVisitorMixin::VisitChain`.
+        llvm::DenseMap< const clang::Expr *, Operation * > chain_operands;
+
+        // Emit declarations without bodies and initializers.
+        bool signatures_only = false;
+
+        // Emit integer constant expressions as constants, see
+        // `codegen_options::fold_constants`.
+        bool fold_constants = false;
+
+        // Placeholders of unsupported nodes, see `UnsupportedFallBackVisitorMixin`.
+        unsupported_stats unsupported;
+
+        bool emits_definition(const clang::Decl *decl) const {
+            return !signatures_only && passes_filter(decl);
+        }
+
+        //
+        // Translated types
+        //
+        // Types are keyed by the sugared type, it determines the canonical type,
+        // but the translation preserves its sugar (e.g., typedef names).
+        //
+        using TypeCacheKey = std::pair< clang::QualType, unsigned >;
+        llvm::DenseMap< TypeCacheKey, mlir::Type > types;
+        type_cache_stats type_stats;
+
+        // Memoize translated types, see `codegen_options::type_cache`.
+        bool type_cache = true;
+
+        mlir::Type cached_type(clang::QualType ty, type_form form, auto &&translate) {
+            // Incomplete types are not cached, because the data layout of a tag
+            // is stored only once it is defined. A recorded body layout needs
+            // all types of the body to be visited.
+            if (!type_cache || body_layout || ty->isIncompleteType()) {
+                return translate();
+            }
+
+            auto key = TypeCacheKey{ ty, static_cast< unsigned >(form) };
+            if (auto it = types.find(key); it != types.end()) {
+                ++type_stats.hits;
+                return it->second;
             }
 
-            std::string name;
-            for (const auto *dctx : llvm::reverse(dctxs)) {
+            if (parent) {
+                if (auto it = parent->types.find(key); it != parent->types.end()) {
+                    ++type_stats.hits;
+                    return it->second;
+                }
+            }
+
+            ++type_stats.misses;
+            auto result = translate();
+            if (result) {
+                types.try_emplace(key, result);
+            }
+
+            return result;
+        }
+
+        // Records data layout of types used by the function body being emitted,
+        // so that it can be restored when the body is reused.
+        dl::DataLayoutBlueprint *body_layout = nullptr;
+
+        // Names of anonymous declarations are interned, so that they outlive
+        // the query as names of other declarations do.
+        llvm::StringRef get_decl_name(const clang::NamedDecl *decl) {
+            if (decl->getIdentifier())
+                return decl->getName();
+            return mlir::StringAttr::get(
+                &mctx, "anonymous[" + llvm::Twine(decl->getID()) + "]"
+            ).getValue();
+        }
+
+        // The closest enclosing tag, functions are skipped.
+        static const clang::TagDecl *enclosing_tag(const clang::TagDecl *decl) {
+            for (const auto *dctx = decl->getDeclContext(); dctx; dctx = dctx->getParent()) {
                 if (llvm::isa< clang::TranslationUnitDecl >(dctx))
-                    continue;
+                    return nullptr;
 
                 if (llvm::isa< clang::FunctionDecl >(dctx))
                     continue;
 
-                if (const auto *d = llvm::dyn_cast< clang::TagDecl >(dctx)) {
-                    name += get_decl_name(d);
-                } else {
-                    VAST_UNREACHABLE("unknown decl context: {0}", dctx->getDeclKindName());
-                }
+                if (const auto *d = llvm::dyn_cast< clang::TagDecl >(dctx))
+                    return d;
 
-                name += "::";
+                VAST_UNREACHABLE("unknown decl context: {0}", dctx->getDeclKindName());
             }
 
-            return name;
+            return nullptr;
         }
 
-        std::string get_namespaced_decl_name(const clang::TagDecl *decl) {
-            return get_namespaced_for_decl_name(decl) + get_decl_name(decl);
+        //
+        // Names of tags
+        //
+        // Tags are named by their namespaced names, e.g., `outer::inner`. Names
+        // are interned once per canonical declaration, each of them is built
+        // from the cached name of the enclosing tag.
+        //
+        llvm::DenseMap< const clang::TagDecl *, mlir::StringAttr > tag_names;
+
+        bool has_decl_name(const clang::TagDecl *decl) const {
+            return tag_names.count(decl->getCanonicalDecl());
         }
 
-        llvm::StringRef decl_name(const clang::TagDecl *decl) {
-            if (tag_names.count(decl)) {
-                return tag_names[decl];
+        mlir::StringAttr decl_name(const clang::TagDecl *decl) {
+            decl = decl->getCanonicalDecl();
+            if (auto it = tag_names.find(decl); it != tag_names.end()) {
+                return it->second;
+            }
+
+            if (parent) {
+                if (auto it = parent->tag_names.find(decl); it != parent->tag_names.end()) {
+                    return it->second;
+                }
+            }
+
+            llvm::SmallString< 64 > name;
+            if (auto scope = enclosing_tag(decl)) {
+                name += decl_name(scope).getValue();
+                name += "::";
             }
+            name += get_decl_name(decl);
 
-            auto name = get_namespaced_decl_name(decl);
-            auto [it, _] = tag_names.try_emplace(decl, name);
-            return it->second;
+            auto attr = mlir::StringAttr::get(&mctx, name);
+            tag_names.try_emplace(decl, attr);
+            return attr;
         }
 
         const dl::DataLayoutBlueprint &data_layout() const { return dl; }
         dl::DataLayoutBlueprint &data_layout() { return dl; }
 
+        void store_data_layout(mlir::Type mty, const clang::Type *aty) {
+            if (body_layout) {
+                body_layout->try_emplace(mty, aty, actx);
+            }
+
+            if (!parent) {
+                dl.try_emplace(mty, aty, actx);
+                return;
+            }
+
+            if (parent->dl.entries.count(mty)) {
+                return;
+            }
+
+            // clang computes type info lazily, workers need to synchronize on it
+            std::lock_guard lock(*actx_mutex);
+            dl.try_emplace(mty, aty, actx);
+        }
+
         mlir::Region &getBodyRegion() { return mod->getBodyRegion(); }
 
         auto error(llvm::Twine msg) { return mod->emitError(msg); }
@@ -125,7 +294,9 @@ namespace vast::hl
         }
 
         FuncOp lookup_function(const clang::FunctionDecl *decl, bool with_error = true) {
-            return symbol(funcdecls, decl, "error: undeclared function '" + decl->getName() + "'", with_error);
+            // functions are keyed by their canonical declaration, so any redeclaration finds them
+            auto canonical = decl->getCanonicalDecl();
+            return symbol(funcdecls, canonical, "error: undeclared function '" + decl->getName() + "'", with_error);
         }
 
         //
@@ -0,0 +1,190 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Support/LogicalResult.h>
+#include <mlir/Support/TypeID.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // decl_table
+    //
+    // Symbols of declarations of all kinds (variables, functions, types, enum
+    // constants and labels) in a single table keyed by the declaration.
+    // Values are stored as opaque pointers of mlir values or operations, the
+    // typed `view`s restore them. Each entry is tagged by the kind of its
+    // value, so that a lookup through a view of another kind (e.g., of a
+    // typedef through the view of type declarations) is caught.
+    //
+    // Entries live in two arenas indexed by a single map. File-scope entries
+    // are never removed. Entries of scoped kinds declared in a scope (e.g.,
+    // variables of a function body) are appended to the local arena, that is
+    // truncated to the scope marker when the scope is popped. Index entries
+    // of popped symbols are detected as stale by their position and purged
+    // once they outnumber the live ones.
+    //
+    struct decl_table {
+        using decl_t = const clang::Decl *;
+
+        struct entry {
+            decl_t decl;
+            const void *value;
+            mlir::TypeID kind;
+        };
+
+        template< typename Value >
+        static mlir::TypeID kind_of() { return mlir::TypeID::get< Value >(); }
+
+        // Falls back to the parent table if the symbol is not declared in this one.
+        template< typename Value >
+        Value lookup(decl_t decl) const {
+            if (auto e = find(decl)) {
+                VAST_ASSERT(e->kind == kind_of< Value >());
+                return Value::getFromOpaquePointer(e->value);
+            }
+            return parent ? parent->lookup< Value >(decl) : Value();
+        }
+
+        template< typename Value >
+        mlir::LogicalResult declare(decl_t decl, Value value, bool scoped) {
+            auto [it, inserted] = index.try_emplace(decl);
+            if (!inserted && valid(decl, it->second)) {
+                return mlir::failure();
+            }
+
+            entry e{ decl, value.getAsOpaquePointer(), kind_of< Value >() };
+            if (scoped && !markers.empty()) {
+                it->second = slot(locals.size()) | local_bit;
+                locals.push_back(e);
+            } else {
+                it->second = slot(globals.size());
+                globals.push_back(e);
+            }
+
+            return mlir::success();
+        }
+
+        //
+        // Scopes
+        //
+        void push_scope() { markers.push_back(locals.size()); }
+
+        void pop_scope() {
+            VAST_ASSERT(!markers.empty());
+            auto marker = markers.pop_back_val();
+            stale += locals.size() - marker;
+            locals.resize(marker);
+
+            if (stale > live()) {
+                purge();
+            }
+        }
+
+        // Declares scoped symbols of the enclosed code, e.g., of a function body.
+        struct scope {
+            explicit scope(decl_table &table) : table(table) { table.push_scope(); }
+            ~scope() { table.pop_scope(); }
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            decl_table &table;
+        };
+
+        //
+        // view
+        //
+        // Typed access to symbols of one kind. Symbols of scoped kinds are
+        // removed when their scope is popped, the others are file-scope ones
+        // wherever they are declared (e.g., local function prototypes). The
+        // same holds for file-scope variables emitted lazily from a function
+        // body on their first reference.
+        //
+        template< typename Decl, typename Value, bool scoped = false >
+        struct view {
+            using ValueType = Value;
+
+            Value lookup(const Decl *decl) const { return table.lookup< Value >(decl); }
+
+            mlir::LogicalResult declare(const Decl *decl, Value value) {
+                return table.declare(decl, value, scoped && !file_scope(decl));
+            }
+
+            static bool file_scope(const Decl *decl) {
+                if constexpr (std::is_base_of_v< clang::VarDecl, Decl >) {
+                    return decl->isFileVarDecl();
+                } else {
+                    return false;
+                }
+            }
+
+            decl_table &table;
+        };
+
+        // Table whose symbols are visible, but never modified, through this one.
+        const decl_table *parent = nullptr;
+
+      private:
+        using slot = std::uint32_t;
+        static constexpr slot local_bit = slot(1) << 31;
+
+        bool valid(decl_t decl, slot s) const {
+            if (!(s & local_bit))
+                return true;
+            auto pos = s & ~local_bit;
+            return pos < locals.size() && locals[pos].decl == decl;
+        }
+
+        const entry *find(decl_t decl) const {
+            auto it = index.find(decl);
+            if (it == index.end())
+                return nullptr;
+
+            auto s = it->second;
+            if (!(s & local_bit))
+                return &globals[s];
+
+            auto pos = s & ~local_bit;
+            if (pos < locals.size() && locals[pos].decl == decl)
+                return &locals[pos];
+            return nullptr;
+        }
+
+        std::size_t live() const { return globals.size() + locals.size(); }
+
+        void purge() {
+            for (auto it = index.begin(), end = index.end(); it != end;) {
+                auto cur = it++;
+                if (!valid(cur->first, cur->second)) {
+                    index.erase(cur);
+                }
+            }
+            stale = 0;
+        }
+
+        llvm::DenseMap< decl_t, slot > index;
+
+        std::vector< entry > globals;
+        std::vector< entry > locals;
+
+        llvm::SmallVector< std::size_t, 4 > markers;
+        std::size_t stale = 0;
+    };
+
+    using decl_scope = decl_table::scope;
+
+} // namespace vast::hl
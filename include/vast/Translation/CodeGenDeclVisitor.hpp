@@ -7,6 +7,7 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/DeclVisitor.h>
 #include <clang/AST/Attr.h>
+#include <clang/AST/RecursiveASTVisitor.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Translation/CodeGenMeta.hpp"
@@ -14,7 +15,6 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Translation/CodeGenVisitorBase.hpp"
 #include "vast/Translation/CodeGenVisitorLens.hpp"
 #include "vast/Dialect/HighLevel/HighLevelLinkage.hpp"
-#include "vast/Translation/Util.hpp"
 
 namespace vast::hl {
 
@@ -63,82 +63,188 @@ namespace vast::hl {
             }
         }
 
-        Operation* VisitFunctionDecl(const clang::FunctionDecl *decl) {
-            InsertionGuard guard(op_builder());
-            auto is_definition = decl->doesThisDeclarationHaveABody();
+        //
+        // Function Declaration
+        //
 
-            // emit definition instead of declaration
-            if (!is_definition && decl->getDefinition()) {
-                return visit(decl->getDefinition());
+        void declare_function_params(const clang::FunctionDecl *decl, mlir::Block *entry) {
+            // In MLIR the entry block of the function must have the same
+            // argument list as the function itself.
+            auto params = llvm::zip(decl->getDefinition()->parameters(), entry->getArguments());
+            for (const auto &[arg, earg] : params) {
+                declare(arg, earg);
             }
+        }
+
+        void emit_function_terminator(const clang::FunctionDecl *decl, FuncOp fn) {
+            auto loc = fn.getLoc();
+            if (decl->getReturnType()->isVoidType()) {
+                make< ReturnOp >(loc);
+            } else {
+                if (decl->isMain()) {
+                    // return zero if no return is present in main
+                    auto type = fn.getFunctionType();
+                    auto zero = constant(loc, type.getResult(0), apsint(0));
+                    make< ReturnOp >(loc, zero);
+                } else {
+                    make< UnreachableOp >(loc);
+                }
+            }
+        }
+
+        // Fills the entry block of `fn` with the body of its definition.
+        void emit_function_body(FuncOp fn, const clang::FunctionDecl *decl) {
+            InsertionGuard guard(op_builder());
+            // parameters, labels and local variables
+            decl_scope scope(context().symbols);
 
             auto is_terminator = [] (auto &op) {
                 return op.template hasTrait< mlir::OpTrait::IsTerminator >();
             };
 
-            auto declare_function_params = [&] (auto entry) {
-                // In MLIR the entry block of the function must have the same
-                // argument list as the function itself.
-                auto params = llvm::zip(decl->getDefinition()->parameters(), entry->getArguments());
-                for (const auto &[arg, earg] : params) {
-                    declare(arg, earg);
+            auto entry = &fn.front();
+            set_insertion_point_to_start(entry);
+
+            if (decl->hasBody()) {
+                declare_function_params(decl, entry);
+
+                // emit label declarations
+                filter< clang::LabelDecl >(decl->decls(), [&] (auto lab) {
+                    visit(lab);
+                });
+
+                visit(decl->getBody());
+            }
+
+            // Trailing scopes are inlined when the module is frozen, the
+            // terminator goes to the end of the innermost one.
+            auto last_block = &fn.getBlocks().back();
+            while (!last_block->empty()) {
+                auto scope = mlir::dyn_cast< ScopeOp >(last_block->back());
+                if (!scope || scope.getBody().empty()) {
+                    break;
                 }
+                last_block = &scope.getBody().back();
+            }
+
+            auto &ops = last_block->getOperations();
+            set_insertion_point_to_end(last_block);
+
+            if (ops.empty() || !is_terminator(ops.back())) {
+                emit_function_terminator(decl, fn);
+            }
+        }
+
+        // Body can be emitted out of order, if it declares only local variables and
+        // labels, and refers only to already declared functions. Otherwise, its emission
+        // would add new symbols to the module.
+        bool is_self_contained_body(const clang::FunctionDecl *decl) {
+            auto is_local = [] (const clang::Decl *d) {
+                return clang::isa< clang::VarDecl, clang::LabelDecl >(d);
             };
 
-            auto emit_function_terminator = [&] (auto fn) {
-                auto loc = fn.getLoc();
-                if (decl->getReturnType()->isVoidType()) {
-                    make< ReturnOp >(loc);
-                } else {
-                    if (decl->isMain()) {
-                        // return zero if no return is present in main
-                        auto type = fn.getFunctionType();
-                        auto zero = constant(loc, type.getResult(0), apsint(0));
-                        make< ReturnOp >(loc, zero);
-                    } else {
-                        make< UnreachableOp >(loc);
+            if (!llvm::all_of(decl->decls(), is_local)) {
+                return false;
+            }
+
+            struct callee_check : clang::RecursiveASTVisitor< callee_check > {
+                explicit callee_check(CodeGenContext &ctx) : ctx(ctx) {}
+
+                bool VisitDeclRefExpr(clang::DeclRefExpr *ref) {
+                    if (auto fn = clang::dyn_cast< clang::FunctionDecl >(ref->getDecl())) {
+                        declared = static_cast< bool >(ctx.lookup_function(fn, false /* with error */));
                     }
+
+                    return declared;
                 }
-            };
 
-            auto emit_function_body = [&] (auto fn) {
-                auto entry = fn.addEntryBlock();
-                set_insertion_point_to_start(entry);
+                CodeGenContext &ctx;
+                bool declared = true;
+            } check(context());
 
-                if (decl->hasBody()) {
-                    declare_function_params(entry);
+            check.TraverseStmt(decl->getBody());
+            return check.declared;
+        }
 
-                    // emit label declarations
-                    llvm::ScopedHashTableScope labels_scope(context().labels);
-                    filter< clang::LabelDecl >(decl->decls(), [&] (auto lab) {
-                        visit(lab);
-                    });
+        // Moves the body of an unchanged definition from the previous emission,
+        // see `incremental_state`.
+        bool reuse_function_body(FuncOp fn, const clang::FunctionDecl *decl, const body_fingerprint &print) {
+            auto &state = *context().incremental;
 
-                    visit(decl->getBody());
-                }
+            auto prev = state.previous_bodies.find(fn.getName());
+            if (prev == state.previous_bodies.end() || prev->second.hash != print.hash) {
+                return false;
+            }
 
-                // TODO make as pass
-                splice_trailing_scopes(fn);
+            auto old = state.previous_functions.lookup(fn.getName());
+            if (!old || !is_self_contained_body(decl)) {
+                return false;
+            }
 
-                auto &last_block = fn.getBlocks().back();
-                auto &ops        = last_block.getOperations();
-                set_insertion_point_to_end(&last_block);
+            const auto &prev_print = prev->second;
+            fn.getBody().takeBody(old.getBody());
 
-                if (ops.empty() || !is_terminator(ops.back())) {
-                    emit_function_terminator(fn);
-                }
-            };
+            auto delta = static_cast< int >(print.line) - static_cast< int >(prev_print.line);
+            shift_locations(fn.getBody(), prev_print.file, prev_print.line, prev_print.lines, delta);
+
+            for (const auto &entry : prev_print.layout) {
+                context().data_layout().entries.try_emplace(entry.type, entry);
+            }
+
+            auto &next = state.bodies[fn.getName()] = print;
+            next.layout = prev_print.layout;
+            ++state.reused;
+            return true;
+        }
+
+        void emit_function_body_incrementally(FuncOp fn, const clang::FunctionDecl *decl) {
+            auto &state = *context().incremental;
+
+            auto print = fingerprint(decl, acontext());
+            if (!print) {
+                return emit_function_body(fn, decl);
+            }
+
+            if (reuse_function_body(fn, decl, *print)) {
+                return;
+            }
+
+            dl::DataLayoutBlueprint layout;
+            context().body_layout = &layout;
+            emit_function_body(fn, decl);
+            context().body_layout = nullptr;
+
+            for (const auto &[_, entry] : layout.entries) {
+                print->layout.push_back(entry);
+            }
+
+            state.bodies[fn.getName()] = std::move(*print);
+            ++state.emitted;
+        }
+
+        Operation* VisitFunctionDecl(const clang::FunctionDecl *decl) {
+            InsertionGuard guard(op_builder());
+            auto is_definition = decl->doesThisDeclarationHaveABody()
+                && context().emits_definition(decl);
 
-            llvm::ScopedHashTableScope scope(context().vars);
+            // emit definition instead of declaration
+            if (auto def = decl->getDefinition(); !is_definition && def && def != decl) {
+                if (context().emits_definition(def)) {
+                    return visit(def);
+                }
+            }
 
             auto linkage = get_function_linkage(decl);
 
+            auto function_type = [&] {
+                return visit(decl->getFunctionType()).template cast< mlir::FunctionType >();
+            };
+
             auto fn = declare(decl, [&] () {
                 auto loc  = meta_location(decl);
-                auto type = visit(decl->getFunctionType()).template cast< mlir::FunctionType >();
                 // make function header, that will be later filled with function body
                 // or returned as declaration in the case of external function
-                return make< FuncOp >(loc, decl->getName(), type, linkage);
+                return make< FuncOp >(loc, decl->getName(), function_type(), linkage);
             });
 
             if (!is_definition) {
@@ -149,8 +255,24 @@ namespace vast::hl {
 
             fn.setVisibility(get_visibility_from_linkage(linkage));
 
-            if (fn.empty()) {
-                emit_function_body(fn);
+            if (fn.empty() && !context().released_bodies.count(fn)) {
+                // The header might have been made from a previous declaration, e.g.,
+                // when a translation unit is streamed, prototypes are emitted before
+                // their definitions are parsed. Definition takes precedence.
+                fn->setLoc(meta_location(decl));
+                fn.setFunctionTypeAttr(mlir::TypeAttr::get(function_type()));
+                fn->setAttr("linkage", GlobalLinkageKindAttr::get(&mcontext(), linkage));
+
+                // entry block marks the function as defined even if its body is deferred
+                fn.addEntryBlock();
+
+                if (context().incremental) {
+                    emit_function_body_incrementally(fn, decl);
+                } else if (context().defer_function_bodies && is_self_contained_body(decl)) {
+                    context().deferred_bodies.emplace_back(fn, decl);
+                } else {
+                    emit_function_body(fn, decl);
+                }
             }
 
             return fn;
@@ -184,7 +306,7 @@ namespace vast::hl {
             return declare(decl, [&] {
                 auto type = decl->getType();
                 bool has_allocator = type->isVariableArrayType();
-                bool has_init = decl->getInit();
+                bool has_init = decl->getInit() && context().emits_definition(decl);
 
                 auto initializer = make_value_builder(decl->getInit());
 
@@ -225,6 +347,31 @@ namespace vast::hl {
 
         // Operation* VisitLinkageSpecDecl(const clang::LinkageSpecDecl *decl)
 
+        // Emits a declaration rejected by `CodeGenContext::decl_filter` on its
+        // first reference. It is emitted to the module scope, the codegen moves
+        // it before the top-level declaration that references it.
+        void emit_referenced_declaration(const clang::Decl *decl) {
+            if (context().passes_filter(decl)) {
+                return;
+            }
+
+            if (!context().referenced_decls.insert(decl->getCanonicalDecl()).second) {
+                return;
+            }
+
+            InsertionGuard guard(op_builder());
+            auto &body = context().getBodyRegion().front();
+            auto last  = body.empty() ? nullptr : &body.back();
+
+            set_insertion_point_to_end(&body);
+            visit(decl);
+
+            auto op = last ? last->getNextNode() : &body.front();
+            for (; op; op = op->getNextNode()) {
+                context().lazy_declarations.insert(op);
+            }
+        }
+
         Operation* VisitTranslationUnitDecl(const clang::TranslationUnitDecl *tu) {
             auto loc = meta_location(tu);
             return this->template make_scoped< TranslationUnitScope >(loc, [&] {
@@ -339,6 +486,7 @@ namespace vast::hl {
         Operation* VisitEnumConstantDecl(const clang::EnumConstantDecl *decl) {
             return declare(decl, [&] {
                 auto initializer = make_value_builder(decl->getInitExpr());
+                auto has_init = decl->getInitExpr() && !context().signatures_only;
 
                 auto type = visit(decl->getType());
 
@@ -347,7 +495,7 @@ namespace vast::hl {
                     .bind(decl->getName())                                  // name
                     .bind(type)                                             // type
                     .bind(decl->getInitVal())                               // value
-                    .bind_if(decl->getInitExpr(), std::move(initializer))   // initializer
+                    .bind_if(has_init, std::move(initializer))              // initializer
                     .freeze();
             });
         }
@@ -358,7 +506,7 @@ namespace vast::hl {
         template< typename Decl >
         Operation* make_record_decl(const clang::RecordDecl *decl) {
             auto loc  = meta_location(decl);
-            auto name = context().decl_name(decl);
+            auto name = context().decl_name(decl).getValue();
 
             // declare the type first to allow recursive type definitions
             if (!decl->isCompleteDefinition()) {
@@ -400,7 +548,7 @@ namespace vast::hl {
             // define field type if the field defines a new nested type
             if (auto tag = decl->getType()->getAsTagDecl()) {
                 if (tag->isThisDeclarationADefinition()) {
-                    if (!context().tag_names.count(tag)) {
+                    if (!context().has_decl_name(tag)) {
                         visit(tag);
                     }
                 }
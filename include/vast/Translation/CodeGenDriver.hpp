@@ -0,0 +1,59 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/ASTUnit.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Translation/CodeGenOptions.hpp"
+
+#include <memory>
+
+namespace vast::hl
+{
+    // Meta generators of the code generators instantiated in the library.
+    enum class codegen_meta {
+        locations,         // DefaultMetaGenerator
+        identifiers,       // IDMetaGenerator
+        compact_locations  // CompactMetaGenerator
+    };
+
+    //
+    // CodeGenDriver
+    //
+    // Interface of `DefaultCodeGen` with the default visitors. The generators
+    // are instantiated only in `CodeGen.cpp`, this header does not include
+    // the visitors, hence tools that include it do not parse nor instantiate
+    // them. Generators with custom visitors need the whole `CodeGen.hpp` and
+    // instantiate it in each including unit. With
+    // `codegen_options::tolerate_unsupported` the driver uses the tolerant
+    // visitors, that emit placeholders of unsupported nodes.
+    //
+    template< codegen_meta meta = codegen_meta::locations >
+    struct CodeGenDriver
+    {
+        CodeGenDriver(AContext *actx, MContext *mctx, codegen_options opts = {});
+        ~CodeGenDriver();
+
+        OwningModuleRef emit_module(clang::ASTUnit *unit);
+        OwningModuleRef emit_module(clang::Decl *decl);
+
+        void append_to_module(clang::Decl *decl);
+
+        OwningModuleRef freeze();
+
+    private:
+        struct impl;
+        std::unique_ptr< impl > _impl;
+    };
+
+    extern template struct CodeGenDriver< codegen_meta::locations >;
+    extern template struct CodeGenDriver< codegen_meta::identifiers >;
+    extern template struct CodeGenDriver< codegen_meta::compact_locations >;
+
+} // namespace vast::hl
@@ -4,6 +4,16 @@
 
 #include "vast/Util/Warnings.hpp"
 
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+#include <llvm/ADT/Twine.h>
+#include <mlir/IR/Location.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/CodeGenBuilder.hpp"
+
+#include <mutex>
+
 namespace vast::hl
 {
     template< typename Derived >
@@ -46,6 +56,103 @@ namespace vast::hl
         using TypeVisitor::Visit;
     };
 
+    //
+    // UnsupportedFallBackVisitorMixin
+    //
+    // Emits placeholders of unsupported nodes instead of aborting, so that the
+    // rest of the translation unit is still translated. Statements and
+    // expressions become `hl.unsupported`, declarations `hl.unsupported.decl`
+    // and types `!hl.unsupported`, all named by the kind of the clang node.
+    // Placeholders are counted by kind in `CodeGenContext::unsupported`.
+    //
+    // Placeholder operations keep the full source range of the node, whatever
+    // metadata the meta generator attaches. Types are uniqued, hence their
+    // placeholders are identified by the kind only.
+    //
+    template< typename Derived >
+    struct UnsupportedFallBackVisitorMixin
+        : CodeGenVisitorLens< UnsupportedFallBackVisitorMixin< Derived >, Derived >
+        , CodeGenBuilderMixin< UnsupportedFallBackVisitorMixin< Derived >, Derived >
+    {
+        using LensType = CodeGenVisitorLens< UnsupportedFallBackVisitorMixin< Derived >, Derived >;
+
+        using LensType::acontext;
+        using LensType::context;
+        using LensType::mcontext;
+
+        using LensType::meta_location;
+
+        using LensType::visit;
+        using LensType::visit_as_lvalue_type;
+
+        using Builder = CodeGenBuilderMixin< UnsupportedFallBackVisitorMixin< Derived >, Derived >;
+
+        using Builder::create;
+
+        Operation* Visit(const clang::Stmt *stmt) {
+            // expressions keep their type, so that their users can be emitted
+            Type type;
+            if (auto expr = clang::dyn_cast< clang::Expr >(stmt)) {
+                auto ty = expr->getType();
+                type = expr->isGLValue() ? visit_as_lvalue_type(ty) : visit(ty);
+            }
+
+            llvm::StringRef kind = stmt->getStmtClassName();
+            count(kind);
+            auto range = source_range(stmt->getSourceRange());
+            return create< UnsupportedOp >(meta_location(stmt), type, kind, range);
+        }
+
+        Operation* Visit(const clang::Decl *decl) {
+            auto kind = (llvm::Twine(decl->getDeclKindName()) + "Decl").str();
+            count(kind);
+            auto range = source_range(decl->getSourceRange());
+            return create< UnsupportedDeclOp >(meta_location(decl), kind, range);
+        }
+
+        Type Visit(clang::QualType type) { return Visit(type.getTypePtr()); }
+
+        Type Visit(const clang::Type *type) {
+            llvm::StringRef kind = type->getTypeClassName();
+            count(kind);
+            return UnsupportedType::get(&mcontext(), kind);
+        }
+
+        void count(llvm::StringRef kind) { ++context().unsupported.counts[kind]; }
+
+        // Location of the first and the last token of the range, built from
+        // the source manager independently of the meta generator. Unknown
+        // ranges are omitted.
+        mlir::LocationAttr source_range(clang::SourceRange range) {
+            if (range.isInvalid()) {
+                return {};
+            }
+
+            // line tables are computed lazily, workers synchronize on them
+            std::unique_lock< std::mutex > lock;
+            if (context().actx_mutex) {
+                lock = std::unique_lock(*context().actx_mutex);
+            }
+
+            const auto &sm = acontext().getSourceManager();
+            auto location = [&] (clang::SourceLocation loc) -> mlir::Location {
+                auto presumed = sm.getPresumedLoc(sm.getFileLoc(loc));
+                if (presumed.isInvalid()) {
+                    return mlir::UnknownLoc::get(&mcontext());
+                }
+
+                return mlir::FileLineColLoc::get(
+                    &mcontext(), presumed.getFilename(), presumed.getLine(), presumed.getColumn()
+                );
+            };
+
+            // fused location of a single token folds to the token location
+            return mlir::FusedLoc::get(
+                { location(range.getBegin()), location(range.getEnd()) }, {}, &mcontext()
+            );
+        }
+    };
+
     //
     // CodeGenFallBackVisitorMixin
     //
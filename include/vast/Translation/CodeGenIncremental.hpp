@@ -0,0 +1,96 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/IR/Region.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/DataLayout.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // Incremental emission
+    //
+    // Function bodies make up the bulk of emitted modules. When a translation
+    // unit is lifted repeatedly (e.g., in the repl), the generator moves bodies
+    // of unchanged definitions from the previously emitted module instead of
+    // emitting them again. Declarations, types and globals are always emitted.
+    //
+    struct body_fingerprint {
+        // Hash of the definition (odr hash of its body), of the types it uses
+        // and of its source text.
+        uint64_t hash;
+
+        // Position of the definition, reused bodies are relocated by the
+        // difference of lines.
+        std::string file;
+        unsigned line;
+        unsigned lines;
+
+        // Data layout of the types used in the body.
+        std::vector< dl::DLEntry > layout;
+    };
+
+    // Returns no fingerprint if the definition cannot be safely reused,
+    // e.g., if it is expanded from a macro.
+    std::optional< body_fingerprint > fingerprint(const clang::FunctionDecl *decl, AContext &actx);
+
+    // Shifts locations of operations and block arguments in `region`, that are
+    // in `file` on lines `[from, from + lines]`, by `delta` lines.
+    void shift_locations(mlir::Region &region, string_ref file, unsigned from, unsigned lines, int delta);
+
+    struct incremental_state {
+        // Module of the previous emission with this state. It has to be handed
+        // back by the user before the next emission.
+        OwningModuleRef previous;
+
+        // Fingerprints of bodies of the last emitted module.
+        llvm::StringMap< body_fingerprint > bodies;
+
+        // Statistics of the last emission.
+        std::size_t reused  = 0;
+        std::size_t emitted = 0;
+
+        // Bodies available for reuse during emission.
+        llvm::StringMap< body_fingerprint > previous_bodies;
+        llvm::StringMap< FuncOp > previous_functions;
+
+        void start() {
+            previous_bodies = std::move(bodies);
+            bodies.clear();
+            previous_functions.clear();
+            reused = emitted = 0;
+
+            if (!previous) {
+                previous_bodies.clear();
+                return;
+            }
+
+            for (auto fn : previous->getOps< FuncOp >()) {
+                if (!fn.empty()) {
+                    previous_functions[fn.getName()] = fn;
+                }
+            }
+        }
+
+        void finish() {
+            previous_functions.clear();
+            previous_bodies.clear();
+            previous = nullptr;
+        }
+    };
+
+} // namespace vast::hl
@@ -6,13 +6,23 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
+#include <clang/AST/Mangle.h>
 #include <clang/AST/TypeLoc.h>
 #include <clang/Basic/FileEntry.h>
+#include <clang/Basic/SourceManager.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/Location.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Meta/MetaAttributes.hpp"
 
 #include <concepts>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace vast::hl
 {
@@ -35,53 +45,222 @@ namespace vast::hl
         mlir::Location _location;
     };
 
-    struct DefaultMetaGenerator {
-        DefaultMetaGenerator(AContext *actx, MContext *mctx)
-            : actx(actx), mctx(mctx)
+    //
+    // LocationBuilder
+    //
+    // Builds file locations without queries of the source manager line tables.
+    // Each file gets its name interned once and its own table of line offsets.
+    // Consecutive nodes are usually on the same line, hence the last line is
+    // looked up first.
+    //
+    struct location_builder {
+        location_builder(const clang::SourceManager &sm, MContext *mctx)
+            : sm(sm), mctx(mctx)
         {}
 
-        DefaultMeta get(const clang::FullSourceLoc &loc) const {
+        mlir::Location get(const clang::FullSourceLoc &loc) {
+            // expansions of macros keep locations of the source manager
+            if (loc.isInvalid() || !loc.isFileID()) {
+                return slow_path(loc);
+            }
+
+            auto [fid, offset] = sm.getDecomposedLoc(loc);
+            auto &file = file_info(fid);
+
+            if (!last || last->fid != fid || !last->contains(offset)) {
+                const auto &lines = line_offsets(fid, file);
+                auto next = llvm::upper_bound(lines, offset);
+                auto line = static_cast< unsigned >(std::distance(lines.begin(), next));
+                last = last_line{
+                    .fid   = fid,
+                    .line  = line,
+                    .begin = lines[line - 1],
+                    .end   = next == lines.end() ? ~0u : *next
+                };
+            }
+
+            auto col = offset - last->begin + 1;
+            return mlir::FileLineColLoc::get(file.name, last->line, col);
+        }
+
+        // Builds a compact location, i.e., the offset of the location in its
+        // file, see `meta::make_offset_location`. Lines of the file are not
+        // needed.
+        mlir::Location get_offset(clang::SourceLocation loc) {
+            if (loc.isInvalid()) {
+                return mlir::UnknownLoc::get(mctx);
+            }
+
+            auto [fid, offset] = sm.getDecomposedLoc(sm.getFileLoc(loc));
+            if (fid.isInvalid()) {
+                return mlir::UnknownLoc::get(mctx);
+            }
+
+            return meta::make_offset_location(file_info(fid).name, offset);
+        }
+
+    private:
+        struct file_entry_info {
+            mlir::StringAttr name;
+            // offsets of line beginnings, the first line begins at zero,
+            // computed on the first query of a line
+            std::vector< unsigned > lines;
+        };
+
+        struct last_line {
+            clang::FileID fid;
+            unsigned line;
+            unsigned begin;
+            unsigned end;
+
+            bool contains(unsigned offset) const { return begin <= offset && offset < end; }
+        };
+
+        mlir::Location slow_path(const clang::FullSourceLoc &loc) const {
             auto file = loc.getFileEntry() ? loc.getFileEntry()->getName() : "unknown";
             auto line = loc.getLineNumber();
             auto col  = loc.getColumnNumber();
-            return { mlir::FileLineColLoc::get(mctx, file, line, col) };
+            return mlir::FileLineColLoc::get(mctx, file, line, col);
+        }
+
+        file_entry_info &file_info(clang::FileID fid) {
+            auto [it, inserted] = files.try_emplace(fid);
+            auto &info = it->second;
+            if (inserted) {
+                auto entry = sm.getFileEntryForID(fid);
+                info.name  = mlir::StringAttr::get(mctx, entry ? entry->getName() : "unknown");
+            }
+
+            return info;
+        }
+
+        const std::vector< unsigned > &line_offsets(clang::FileID fid, file_entry_info &info) {
+            if (!info.lines.empty()) {
+                return info.lines;
+            }
+
+            // the same line breaks as the source manager recognizes
+            auto buffer = sm.getBufferData(fid);
+            info.lines.push_back(0);
+            for (unsigned i = 0, size = unsigned(buffer.size()); i < size; ++i) {
+                if (buffer[i] == '\n') {
+                    info.lines.push_back(i + 1);
+                } else if (buffer[i] == '\r') {
+                    if (i + 1 < size && buffer[i + 1] == '\n') {
+                        ++i;
+                    }
+                    info.lines.push_back(i + 1);
+                }
+            }
+
+            return info.lines;
         }
 
-        DefaultMeta get(const clang::SourceLocation &loc) const {
+        const clang::SourceManager &sm;
+        MContext *mctx;
+
+        llvm::DenseMap< clang::FileID, file_entry_info > files;
+        std::optional< last_line > last;
+    };
+
+    struct DefaultMetaGenerator {
+        DefaultMetaGenerator(AContext *actx, MContext *mctx)
+            : actx(actx), mctx(mctx), locations(actx->getSourceManager(), mctx)
+        {}
+
+        DefaultMeta get(const clang::FullSourceLoc &loc) {
+            return { locations.get(loc) };
+        }
+
+        DefaultMeta get(const clang::SourceLocation &loc) {
             return get(clang::FullSourceLoc(loc, actx->getSourceManager()));
         }
 
-        DefaultMeta get(const clang::Decl *decl) const {
+        DefaultMeta get(const clang::Decl *decl) {
             return get(decl->getLocation());
         }
 
-        DefaultMeta get(const clang::Stmt *stmt) const {
+        DefaultMeta get(const clang::Stmt *stmt) {
             // TODO: use SoureceRange
             return get(stmt->getBeginLoc());
         }
 
-        DefaultMeta get(const clang::Expr *expr) const {
+        DefaultMeta get(const clang::Expr *expr) {
             // TODO: use SoureceRange
             return get(expr->getExprLoc());
         }
 
-        DefaultMeta get(const clang::TypeLoc &loc) const {
+        DefaultMeta get(const clang::TypeLoc &loc) {
             // TODO: use SoureceRange
             return get(loc.getBeginLoc());
         }
 
-        DefaultMeta get(const clang::Type *type) const {
+        DefaultMeta get(const clang::Type *type) {
             return get(clang::TypeLoc(type, nullptr));
         }
 
-        DefaultMeta get(clang::QualType type) const {
+        DefaultMeta get(clang::QualType type) {
             return get(clang::TypeLoc(type, nullptr));
         }
 
         AContext *actx;
         MContext *mctx;
+
+        // caches of files, queries do not change the generator otherwise
+        location_builder locations;
     };
 
+    //
+    // CompactMetaGenerator
+    //
+    // Attaches offsets of beginnings of source ranges as plain file locations
+    // (see `meta::make_offset_location`). Each operation refers to a single
+    // uniqued location and the module carries no line tables, lines are
+    // resolved from the source when queried.
+    //
+    struct CompactMetaGenerator {
+        CompactMetaGenerator(AContext *actx, MContext *mctx)
+            : actx(actx), mctx(mctx), locations(actx->getSourceManager(), mctx)
+        {}
+
+        DefaultMeta get(clang::SourceRange range) {
+            return { locations.get_offset(range.getBegin()) };
+        }
+
+        DefaultMeta get(const clang::Decl *decl) { return get(decl->getSourceRange()); }
+        DefaultMeta get(const clang::Stmt *stmt) { return get(stmt->getSourceRange()); }
+        DefaultMeta get(const clang::Expr *expr) { return get(expr->getSourceRange()); }
+
+        DefaultMeta get(const clang::TypeLoc &loc) { return get(loc.getSourceRange()); }
+
+        DefaultMeta get(const clang::Type *type) {
+            return get(clang::TypeLoc(type, nullptr));
+        }
+
+        DefaultMeta get(clang::QualType type) {
+            return get(clang::TypeLoc(type, nullptr));
+        }
+
+        AContext *actx;
+        MContext *mctx;
+
+        location_builder locations;
+    };
+
+    //
+    // IDMetaGenerator
+    //
+    // Identifiers do not depend on the order of emission. Declarations outside
+    // of functions are identified by their USRs, other nodes by the identifier
+    // of the enclosing declaration and their position in its traversal. Hence
+    // identifiers of nodes change only when their enclosing declaration does.
+    // Nodes without USRs that are not reached by the traversal are identified
+    // by their parent and an ordinal. Types are identified by USRs of their
+    // canonical types, hence equal types share an identifier.
+    //
+    // Caches are guarded by the generator, it can be shared by workers of the
+    // parallel emission.
+    //
     struct IDMetaGenerator {
         IDMetaGenerator(AContext *actx, MContext *mctx)
             : actx(actx), mctx(mctx)
@@ -96,18 +275,71 @@ namespace vast::hl
             return make_location(meta::IdentifierAttr::get(mctx, id));
         }
 
-        DefaultMeta get_impl(auto token) const { return { make_location(counter++) }; }
-
-        DefaultMeta get(const clang::Decl *decl) const { return get_impl(decl); }
-        DefaultMeta get(const clang::Stmt *stmt) const { return get_impl(stmt); }
-        DefaultMeta get(const clang::Expr *expr) const { return get_impl(expr); }
-        DefaultMeta get(const clang::Type *type) const { return get_impl(type); }
-        DefaultMeta get(clang::QualType type) const { return get_impl(type); }
+        DefaultMeta get_impl(auto token) {
+            std::lock_guard lock(mutex);
+            return { make_location(identifier(token)) };
+        }
 
-        mutable meta::identifier_t counter = 0;
+        DefaultMeta get(const clang::Decl *decl) { return get_impl(decl); }
+        DefaultMeta get(const clang::Stmt *stmt) { return get_impl(stmt); }
+        DefaultMeta get(const clang::Expr *expr) { return get_impl(expr); }
+        DefaultMeta get(const clang::Type *type) { return get_impl(clang::QualType(type, 0)); }
+        DefaultMeta get(clang::QualType type) { return get_impl(type); }
 
         AContext *actx;
         MContext *mctx;
+
+    private:
+        // queries of identifiers fill the caches, hence they hold the `mutex`
+        meta::identifier_t identifier(const clang::Decl *decl);
+        meta::identifier_t identifier(const clang::Stmt *stmt);
+        meta::identifier_t identifier(clang::QualType type);
+
+        meta::identifier_t owner_identifier(const clang::Decl *owner);
+
+        meta::identifier_t sibling_identifier(const clang::Decl *decl);
+
+        meta::identifier_t ordinal_identifier(
+            const void *node, meta::identifier_t parent, llvm::StringRef kind
+        );
+
+        const clang::Decl *enclosing_decl(const clang::Stmt *stmt);
+
+        clang::MangleContext &mangler();
+
+        std::mutex mutex;
+
+        // identifiers of declarations outside of functions
+        llvm::DenseMap< const clang::Decl *, meta::identifier_t > owners;
+        // identifiers of nodes of traversed owners
+        llvm::DenseMap< const void *, meta::identifier_t > nodes;
+        // identifiers of canonical types
+        llvm::DenseMap< const void *, meta::identifier_t > types;
+        // counts of nodes of a kind identified by their ordinal under a parent
+        llvm::DenseMap< std::pair< meta::identifier_t, meta::identifier_t >, std::uint64_t > ordinals;
+
+        std::unique_ptr< clang::MangleContext > mangle_context;
+    };
+
+    //
+    // SynchronizedMetaGenerator
+    //
+    // Shares a generator among threads. Clang source manager caches results
+    // of location queries, hence queries need to be serialized.
+    //
+    template< MetaGeneratorLike MetaGenerator >
+    struct SynchronizedMetaGenerator {
+        SynchronizedMetaGenerator(MetaGenerator &gen, std::mutex &mutex)
+            : gen(gen), mutex(mutex)
+        {}
+
+        auto get(auto token) {
+            std::lock_guard lock(mutex);
+            return gen.get(token);
+        }
+
+        MetaGenerator &gen;
+        std::mutex &mutex;
     };
 
 } // namespace vast::hl
@@ -0,0 +1,97 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace vast::hl
+{
+    struct incremental_state;
+
+    struct type_cache_stats {
+        std::size_t hits   = 0;
+        std::size_t misses = 0;
+
+        type_cache_stats &operator+=(const type_cache_stats &other) {
+            hits   += other.hits;
+            misses += other.misses;
+            return *this;
+        }
+    };
+
+    // Counts of placeholders of unsupported nodes by the kind of the node,
+    // see `UnsupportedFallBackVisitorMixin`.
+    struct unsupported_stats {
+        llvm::StringMap< std::size_t > counts;
+
+        bool empty() const { return counts.empty(); }
+
+        unsupported_stats &operator+=(const unsupported_stats &other) {
+            for (const auto &entry : other.counts) {
+                counts[entry.getKey()] += entry.getValue();
+            }
+            return *this;
+        }
+    };
+
+    struct codegen_options {
+        // Emit self-contained function bodies after all top-level declarations,
+        // in parallel on threads of the mlir context. The result is the same as
+        // of the serial emission, as long as the meta generator does not depend
+        // on the order of emission.
+        bool parallel_bodies = false;
+
+        // Reuse bodies of definitions that did not change since the previous
+        // emission with the same state. Bodies are emitted serially.
+        incremental_state *incremental = nullptr;
+
+        // Emit only top-level declarations accepted by the filter. Rejected
+        // declarations are emitted on their first reference, and only as
+        // declarations, i.e., without function bodies and initializers.
+        std::function< bool (const clang::Decl *) > decl_filter;
+
+        // Emit only interfaces: function prototypes, globals without
+        // initializers, records, enums and typedefs. Statements and
+        // expressions are never visited.
+        bool signatures_only = false;
+
+        // Emit integer constant expressions (e.g., `sizeof(T) * 4` or `1 << N`)
+        // as a single constant, that records the kind of the folded expression.
+        bool fold_constants = false;
+
+        // Called with each top-level function definition as soon as it is
+        // emitted. The body is released afterwards, only the declaration stays
+        // for symbol resolution and it is removed from the frozen module.
+        // Bodies are emitted serially.
+        std::function< void (Operation *) > stream_definition;
+
+        // Memoize translated types. The output does not depend on it, the
+        // cache is disabled only to compare with the uncached translation.
+        bool type_cache = true;
+
+        // Accumulates hits and misses of the type cache of the generator.
+        type_cache_stats *type_stats = nullptr;
+
+        // Emit placeholders of unsupported statements, declarations and types
+        // instead of aborting. Honored by `CodeGenDriver`, generators with
+        // custom visitors choose their fallback mixin.
+        bool tolerate_unsupported = false;
+
+        // Accumulates counts of placeholders of unsupported nodes.
+        unsupported_stats *unsupported = nullptr;
+
+        bool skips_function_body(const clang::Decl *decl) const {
+            return signatures_only || (decl_filter && !decl_filter(decl));
+        }
+    };
+
+} // namespace vast::hl
@@ -6,6 +6,9 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/StmtVisitor.h>
+#include <llvm/ADT/APFloat.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinTypes.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Translation/CodeGenMeta.hpp"
@@ -16,6 +19,9 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
+#include <mutex>
+#include <numeric>
+
 namespace vast::hl {
 
     CastKind cast_kind(const clang::CastExpr *expr);
@@ -31,6 +37,7 @@ namespace vast::hl {
         using LensType::derived;
         using LensType::context;
         using LensType::mcontext;
+        using LensType::acontext;
 
         using LensType::meta_location;
 
@@ -52,11 +59,168 @@ namespace vast::hl {
 
         using Builder::make_value_yield_region;
 
+        using StmtVisitorBase = clang::ConstStmtVisitor< CodeGenStmtVisitorMixin< Derived >, Operation* >;
+
         template< typename Op, typename... Args >
         auto make(Args &&...args) {
             return this->template create< Op >(std::forward< Args >(args)...);
         }
 
+        Operation* Visit(const clang::Stmt *stmt) {
+            auto expr = clang::dyn_cast< clang::Expr >(stmt);
+            if (!expr) {
+                return StmtVisitorBase::Visit(stmt);
+            }
+
+            auto &operands = context().chain_operands;
+            if (auto it = operands.find(expr); it != operands.end()) {
+                auto op = it->second;
+                operands.erase(it);
+                return op;
+            }
+
+            auto operand = chain_operand(expr);
+            // links of chains are visited after their emitted operands
+            if (!operand || !operands.count(operand)) {
+                if (auto folded = fold_constant(expr)) {
+                    return folded;
+                }
+            }
+
+            if (operand && chain_operand(operand)) {
+                if (!operands.count(operand)) {
+                    return VisitChain(expr);
+                }
+            }
+
+            return StmtVisitorBase::Visit(stmt);
+        }
+
+        //
+        // Constant folding
+        //
+        // With `codegen_options::fold_constants`, integer constant expressions
+        // are emitted as a single `hl.const`. The kind of the folded expression
+        // is kept in the `hl.folded` attribute of the constant.
+        //
+
+        // Chains are checked by clang recursively, longer ones are emitted
+        // op by op, see `VisitChain`.
+        static constexpr unsigned fold_chain_limit = 256;
+
+        Operation* fold_constant(const clang::Expr *expr) {
+            if (!context().fold_constants || !expr->isPRValue()) {
+                return nullptr;
+            }
+
+            if (clang::isa< clang::IntegerLiteral, clang::CharacterLiteral >(expr)) {
+                return nullptr;
+            }
+
+            // enums and other non-builtin integers keep their operations
+            auto ty = expr->getType();
+            if (!ty->isIntegerType() || !ty->isBuiltinType()) {
+                return nullptr;
+            }
+
+            unsigned depth = 0;
+            for (auto link = expr; link; link = chain_operand(link)) {
+                if (++depth > fold_chain_limit) {
+                    return nullptr;
+                }
+            }
+
+            clang::Expr::EvalResult result;
+            {
+                auto lock = lock_acontext();
+                auto &actx = acontext();
+                if (!expr->isIntegerConstantExpr(actx) || !expr->EvaluateAsInt(result, actx)) {
+                    return nullptr;
+                }
+            }
+
+            auto loc   = meta_location(expr);
+            auto value = result.Val.getInt();
+            auto op    = ty->isBooleanType()
+                ? constant(loc, value.getBoolValue()).getDefiningOp()
+                : constant(loc, visit(ty), value).getDefiningOp();
+
+            auto kind = expr->IgnoreParenImpCasts()->getStmtClassName();
+            op->setAttr("hl.folded", mlir::StringAttr::get(&mcontext(), kind));
+            return op;
+        }
+
+        // Clang caches results of evaluation and layout queries, that workers
+        // emitting bodies in parallel need to serialize.
+        std::unique_lock< std::mutex > lock_acontext() {
+            if (auto mutex = context().actx_mutex) {
+                return std::unique_lock(*mutex);
+            }
+            return {};
+        }
+
+        //
+        // Chains of expressions
+        //
+        // Left-leaning chains, e.g., `a + b + c` or `a, b, c`, would cost a stack
+        // frame per operand. A chain is emitted iteratively from its innermost
+        // operand instead, each link is visited when its left operand is already
+        // emitted. The order of emission is the same as of the recursion.
+        //
+
+        // The left operand of expressions whose visitors emit it first and
+        // unconditionally, i.e., `VisitBinOp`, `VisitCmp` and `VisitCast`.
+        static const clang::Expr *chain_operand(const clang::Expr *expr) {
+            if (auto op = clang::dyn_cast< clang::BinaryOperator >(expr)) {
+                switch (op->getOpcode()) {
+                    case clang::BO_PtrMemD:
+                    case clang::BO_PtrMemI:
+                    case clang::BO_Cmp:
+                        return nullptr;
+                    case clang::BO_Div:
+                    case clang::BO_Rem:
+                    case clang::BO_DivAssign:
+                    case clang::BO_RemAssign:
+                        return op->getType()->isIntegerType() ? op->getLHS() : nullptr;
+                    case clang::BO_LT:
+                    case clang::BO_GT:
+                    case clang::BO_LE:
+                    case clang::BO_GE:
+                        return op->getLHS()->getType()->isIntegerType() ? op->getLHS() : nullptr;
+                    default:
+                        return op->getLHS();
+                }
+            }
+
+            if (clang::isa< clang::ImplicitCastExpr, clang::CStyleCastExpr, clang::BuiltinBitCastExpr >(expr)) {
+                return clang::cast< clang::CastExpr >(expr)->getSubExpr();
+            }
+
+            return nullptr;
+        }
+
+        Operation* VisitChain(const clang::Expr *expr) {
+            llvm::SmallVector< const clang::Expr * > links = { expr };
+            while (true) {
+                auto operand = chain_operand(links.back());
+                if (!chain_operand(operand)) {
+                    break;
+                }
+                links.push_back(operand);
+            }
+
+            auto &operands = context().chain_operands;
+            auto result = visit(chain_operand(links.back()));
+            for (auto link : llvm::reverse(links)) {
+                auto operand = chain_operand(link);
+                operands.try_emplace(operand, result);
+                result = visit(link);
+                operands.erase(operand);
+            }
+
+            return result;
+        }
+
         Operation* VisitCompoundStmt(const clang::CompoundStmt *stmt) {
             return this->template make_scoped< HighLevelScope >(meta_location(stmt), [&] {
                 for (auto s : stmt->body()) {
@@ -477,11 +641,13 @@ namespace vast::hl {
         }
 
         VarDeclOp getDefiningOpOfGlobalVar(const clang::VarDecl *decl) {
+            derived().emit_referenced_declaration(decl);
             return context().vars.lookup(decl).template getDefiningOp< VarDeclOp >();
         }
 
         Operation* VisitEnumDeclRefExpr(const clang::DeclRefExpr *expr) {
             auto decl = clang::cast< clang::EnumConstantDecl >(expr->getDecl()->getUnderlyingDecl());
+            derived().emit_referenced_declaration(clang::cast< clang::EnumDecl >(decl->getDeclContext()));
             auto val = context().enumconsts.lookup(decl);
             auto rty = visit(expr->getType());
             return make< EnumRefOp >(meta_location(expr), rty, val.getName());
@@ -508,7 +674,7 @@ namespace vast::hl {
 
         Operation* VisitFunctionDeclRefExpr(const clang::DeclRefExpr *expr) {
             auto decl = clang::cast< clang::FunctionDecl >( expr->getDecl()->getUnderlyingDecl() );
-            auto fn = context().lookup_function(decl);
+            auto fn = VisitDirectCallee(decl);
             auto rty = getLValueReturnType(expr);
 
             return make< FuncRefOp >(meta_location(expr), rty, mlir::SymbolRefAttr::get(fn));
@@ -834,6 +1000,14 @@ namespace vast::hl {
         }
 
         Operation* VisitStringLiteral(const clang::StringLiteral *lit) {
+            // wide strings have no string attribute, they are kept as code units
+            if (lit->getCharByteWidth() != 1) {
+                if (auto elements = dense_elements(lit, 0)) {
+                    auto type = visit(lit->getType());
+                    return constant(meta_location(lit), type, elements).getDefiningOp();
+                }
+            }
+
             return VisitScalarLiteral(lit, lit->getString());
         }
 
@@ -844,6 +1018,10 @@ namespace vast::hl {
         Operation* VisitInitListExpr(const clang::InitListExpr *expr) {
             auto ty = visit(expr->getType());
 
+            if (auto elements = dense_elements(expr, dense_elements_threshold)) {
+                return constant(meta_location(expr), ty, elements).getDefiningOp();
+            }
+
             llvm::SmallVector< Value > elements;
             for (auto elem : expr->inits()) {
                 elements.push_back(visit(elem)->getResult(0));
@@ -851,6 +1029,214 @@ namespace vast::hl {
 
             return make< InitListExpr >(meta_location(expr), ty, elements);
         }
+
+        //
+        // Dense constants
+        //
+        // Fully constant arrays of integers and floats are emitted as a single
+        // `hl.const.dense` instead of an operation per element. Shorter lists
+        // keep their elements, that are easier to read and transform.
+        //
+        // Uniform arrays (e.g., zero-initialized buffers) are stored as splats.
+        // Other arrays are expanded only if their initializers are explicit
+        // for at least a fraction of elements, sparse initializers of large
+        // arrays stay lists of the explicit elements.
+        //
+        static constexpr std::uint64_t dense_elements_threshold = 16;
+        static constexpr std::uint64_t dense_elements_sparsity  = 8;
+
+        // Explicit scalars of an initializer and runs of zeros between them.
+        template< typename Value >
+        struct dense_data {
+            llvm::SmallVector< Value > values;
+            // (number of explicit scalars before the run, length of the run)
+            llvm::SmallVector< std::pair< std::size_t, std::uint64_t > > zeros;
+            std::uint64_t implicit = 0;
+        };
+
+        // Elements of the constant array `expr` in row-major order, or null if
+        // it is not constant or has less than `threshold` elements.
+        mlir::DenseElementsAttr dense_elements(const clang::Expr *expr, std::uint64_t threshold) {
+            auto lock  = lock_acontext();
+            auto &actx = acontext();
+
+            llvm::SmallVector< std::int64_t > shape;
+            auto leaf = expr->getType();
+            while (auto array = actx.getAsConstantArrayType(leaf)) {
+                shape.push_back(std::int64_t(array->getSize().getZExtValue()));
+                leaf = array->getElementType();
+            }
+
+            auto count = std::accumulate(
+                shape.begin(), shape.end(), std::uint64_t(1), std::multiplies<>()
+            );
+
+            if (shape.empty() || count < threshold) {
+                return {};
+            }
+
+            if (leaf->isIntegerType() && !leaf->isBooleanType()) {
+                auto width = unsigned(actx.getTypeSize(leaf));
+                auto type  = mlir::RankedTensorType::get(shape, mlir::IntegerType::get(&mcontext(), width));
+
+                auto zero = llvm::APInt(width, 0);
+                dense_data< llvm::APInt > data;
+                if (!dense_elements(expr, expr->getType(), zero, data)) {
+                    return {};
+                }
+                return make_dense_elements(type, zero, data, count);
+            }
+
+            if (leaf->isRealFloatingType()) {
+                const auto &semantics = actx.getFloatTypeSemantics(leaf);
+                auto element_type = dense_float_type(semantics);
+                if (!element_type) {
+                    return {};
+                }
+
+                auto type = mlir::RankedTensorType::get(shape, element_type);
+
+                auto zero = llvm::APFloat::getZero(semantics);
+                dense_data< llvm::APFloat > data;
+                if (!dense_elements(expr, expr->getType(), zero, data)) {
+                    return {};
+                }
+                return make_dense_elements(type, zero, data, count);
+            }
+
+            return {};
+        }
+
+        template< typename Value >
+        static bool same_scalar(const Value &a, const Value &b) {
+            if constexpr (std::is_same_v< Value, llvm::APInt >) {
+                return a == b;
+            } else {
+                return a.bitwiseIsEqual(b);
+            }
+        }
+
+        template< typename Value >
+        mlir::DenseElementsAttr make_dense_elements(
+            mlir::ShapedType type, const Value &zero, const dense_data< Value > &data, std::uint64_t count
+        ) {
+            const auto &values = data.values;
+            auto uniform = llvm::all_of(values, [&] (const auto &v) { return same_scalar(v, values.front()); });
+            if (values.empty() || (uniform && (data.implicit == 0 || same_scalar(values.front(), zero)))) {
+                auto splat = values.empty() ? zero : values.front();
+                return mlir::DenseElementsAttr::get(type, llvm::makeArrayRef(splat));
+            }
+
+            if (values.size() * dense_elements_sparsity < count) {
+                return {};
+            }
+
+            llvm::SmallVector< Value > elements;
+            elements.reserve(count);
+            auto run = data.zeros.begin();
+            for (std::size_t i = 0; i <= values.size(); ++i) {
+                for (; run != data.zeros.end() && run->first == i; ++run) {
+                    elements.append(run->second, zero);
+                }
+                if (i < values.size()) {
+                    elements.push_back(values[i]);
+                }
+            }
+
+            return mlir::DenseElementsAttr::get(type, elements);
+        }
+
+        mlir::Type dense_float_type(const llvm::fltSemantics &semantics) {
+            auto mctx = &mcontext();
+            if (&semantics == &llvm::APFloat::IEEEhalf())   return mlir::Float16Type::get(mctx);
+            if (&semantics == &llvm::APFloat::BFloat())     return mlir::BFloat16Type::get(mctx);
+            if (&semantics == &llvm::APFloat::IEEEsingle()) return mlir::Float32Type::get(mctx);
+            if (&semantics == &llvm::APFloat::IEEEdouble()) return mlir::Float64Type::get(mctx);
+            return {};
+        }
+
+        // Appends scalars of `init` of type `ty`, missing elements are runs of
+        // zeros.
+        template< typename Value >
+        bool dense_elements(
+            const clang::Expr *init, clang::QualType ty, const Value &zero, dense_data< Value > &data
+        ) {
+            auto &actx = acontext();
+            auto &elements = data.values;
+
+            auto zeros = [&] (clang::QualType type, std::uint64_t n) {
+                while (auto array = actx.getAsConstantArrayType(type)) {
+                    n *= array->getSize().getZExtValue();
+                    type = array->getElementType();
+                }
+
+                if (n != 0) {
+                    data.zeros.emplace_back(elements.size(), n);
+                    data.implicit += n;
+                }
+            };
+
+            if (clang::isa< clang::ImplicitValueInitExpr >(init)) {
+                return zeros(ty, 1), true;
+            }
+
+            auto array = actx.getAsConstantArrayType(ty);
+            if (!array) {
+                clang::Expr::EvalResult result;
+                if (!init->EvaluateAsRValue(result, actx) || result.HasSideEffects) {
+                    return false;
+                }
+
+                if constexpr (std::is_same_v< Value, llvm::APInt >) {
+                    if (!result.Val.isInt()) {
+                        return false;
+                    }
+                    elements.push_back(result.Val.getInt().extOrTrunc(zero.getBitWidth()));
+                } else {
+                    if (!result.Val.isFloat()) {
+                        return false;
+                    }
+                    elements.push_back(result.Val.getFloat());
+                }
+
+                return true;
+            }
+
+            auto size = array->getSize().getZExtValue();
+            auto elem = array->getElementType();
+
+            if (auto lit = clang::dyn_cast< clang::StringLiteral >(init->IgnoreParens())) {
+                if constexpr (std::is_same_v< Value, llvm::APInt >) {
+                    auto units = std::min< std::uint64_t >(lit->getLength(), size);
+                    for (std::uint64_t i = 0; i < units; ++i) {
+                        elements.emplace_back(zero.getBitWidth(), lit->getCodeUnit(unsigned(i)));
+                    }
+                    return zeros(elem, size - units), true;
+                }
+                return false;
+            }
+
+            auto list = clang::dyn_cast< clang::InitListExpr >(init->IgnoreParens());
+            if (!list || list->getNumInits() > size) {
+                return false;
+            }
+
+            if (list->isStringLiteralInit()) {
+                return dense_elements(list->getInit(0), ty, zero, data);
+            }
+
+            for (auto elem_init : list->inits()) {
+                if (!dense_elements(elem_init, elem, zero, data)) {
+                    return false;
+                }
+            }
+
+            if (auto filler = list->getArrayFiller(); filler && !clang::isa< clang::ImplicitValueInitExpr >(filler)) {
+                return false;
+            }
+
+            return zeros(elem, size - list->getNumInits()), true;
+        }
     };
 
 } // namespace vast::hl
@@ -31,8 +31,6 @@ namespace vast::hl {
     {
         using base_type = clang::TypeVisitor< CodeGenTypeVisitorMixin< Derived >, Type >;
 
-        using base_type::Visit;
-
         using LensType = CodeGenVisitorLens< CodeGenTypeVisitorMixin< Derived >, Derived >;
 
         using LensType::derived;
@@ -111,16 +109,19 @@ namespace vast::hl {
         }
 
         auto with_qualifiers(const clang::RecordType *ty, qualifiers quals) -> mlir_type {
-            auto name = make_name_attr( context().decl_name(ty->getDecl()) );
+            derived().emit_referenced_declaration(ty->getDecl());
+            auto name = context().decl_name(ty->getDecl());
             return with_cv_qualifiers( type_builder< RecordType >().bind(name), quals ).freeze();
         }
 
         auto with_qualifiers(const clang::EnumType *ty, qualifiers quals) -> mlir_type {
-            auto name = make_name_attr( context().decl_name(ty->getDecl()) );
+            derived().emit_referenced_declaration(ty->getDecl());
+            auto name = context().decl_name(ty->getDecl());
             return with_cv_qualifiers( type_builder< RecordType >().bind(name), quals ).freeze();
         }
 
         auto with_qualifiers(const clang::TypedefType *ty, qualifiers quals) -> mlir_type {
+            derived().emit_referenced_declaration(ty->getDecl());
             auto name = make_name_attr( ty->getDecl()->getName() );
             return with_cvr_qualifiers( type_builder< TypedefType >().bind(name), quals ).freeze();
         }
@@ -130,7 +131,19 @@ namespace vast::hl {
             return with_cvr_qualifiers(type_builder< ElaboratedType >().bind(element_type), quals).freeze();
         }
 
+        auto Visit(const clang_type *ty) -> mlir_type {
+            return context().cached_type(clang::QualType(ty, 0), type_form::type, [&] {
+                return base_type::Visit(ty);
+            });
+        }
+
         auto Visit(clang::QualType ty) -> mlir_type {
+            return context().cached_type(ty, type_form::qualified_type, [&] {
+                return VisitQualType(ty);
+            });
+        }
+
+        auto VisitQualType(clang::QualType ty) -> mlir_type {
             auto underlying = ty.getTypePtr();
             auto quals      = ty.getQualifiers();
             if (auto t = llvm::dyn_cast< clang::BuiltinType >(underlying)) {
@@ -177,7 +190,7 @@ namespace vast::hl {
                 return VisitDecayedType(t, quals);
             }
 
-            VAST_UNREACHABLE("unsupported qualified type");
+            // unsupported types are left to the fallback visitor
             return Type{};
         }
 
@@ -190,7 +203,9 @@ namespace vast::hl {
         }
 
         auto VisitLValueType(clang::QualType ty) -> mlir_type {
-            return LValueType::get(&mcontext(), visit(ty));
+            return context().cached_type(ty, type_form::lvalue, [&] {
+                return LValueType::get(&mcontext(), visit(ty));
+            });
         }
 
         auto VisitFunctionType(const clang::FunctionType *ty) -> mlir_type {
@@ -338,8 +353,9 @@ namespace vast::hl {
         }
 
         auto StoreDataLayout(const clang_type *orig, mlir_type out) -> mlir_type {
-            if (!orig->isFunctionType() && !is_forward_declared(orig)) {
-                context().data_layout().try_emplace(out, orig, acontext());
+            // unsupported types have no translation, see the fallback mixins
+            if (out && !orig->isFunctionType() && !is_forward_declared(orig)) {
+                context().store_data_layout(out, orig);
             }
 
             return out;
@@ -49,6 +49,10 @@ namespace vast::hl
         using MixinType         = CodeGenVisitorMixin< CodeGenVisitor< CodeGenVisitorMixin, MetaGenerator > >;
         using MetaGeneratorType = MetaGenerator;
 
+        // the same visitor with a different meta generator
+        template< MetaGeneratorLike OtherMetaGenerator >
+        using rebind_meta = CodeGenVisitor< CodeGenVisitorMixin, OtherMetaGenerator >;
+
         CodeGenVisitor(CodeGenContext &ctx, MetaGenerator &gen)
             : BaseType(ctx, gen)
         {}
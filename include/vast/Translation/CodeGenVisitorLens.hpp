@@ -10,7 +10,6 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Translation/CodeGenMeta.hpp"
 #include "vast/Translation/CodeGenVisitorBase.hpp"
-#include "vast/Translation/Util.hpp"
 
 namespace vast::hl {
 
@@ -40,8 +39,8 @@ namespace vast::hl {
         //
         // meta
         //
-        auto &      meta_gen()       { return derived().meta; }
-        const auto &meta_gen() const { return derived().meta; }
+        // the generator is shared by visitors, it is not a part of their state
+        auto &meta_gen() const { return derived().meta; }
 
         template< typename Token >
         mlir::Location meta_location(Token token) const {
@@ -12,6 +12,7 @@ namespace vast
     namespace hl
     {
         mlir::LogicalResult registerFromSourceParser();
+        mlir::LogicalResult registerFromASTParser();
     } // namespace hl
 
     inline void registerAllTranslations()
@@ -21,6 +22,10 @@ namespace vast
             if (vast::hl::registerFromSourceParser().failed()) {
                 llvm::errs() << "Registracion of FromSource pass failed.\n";
             }
+
+            if (vast::hl::registerFromASTParser().failed()) {
+                llvm::errs() << "Registracion of FromAST pass failed.\n";
+            }
         });
     }
 
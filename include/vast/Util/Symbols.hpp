@@ -12,6 +12,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Util/Common.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
 #include "vast/Interfaces/SymbolInterface.hpp"
 
 namespace vast::util
@@ -74,11 +75,15 @@ namespace vast::util
         util::symbols(scope, filter_symbols);
     }
 
-    std::string show_location(auto &value) {
+    // Compact locations are resolved by the `resolver`, that caches lines of
+    // the source files.
+    std::string show_location(auto &value, meta::offset_resolver &resolver) {
         auto loc = value.getLoc();
         std::string buff;
         llvm::raw_string_ostream ss(buff);
-        if (auto file_loc = loc.template dyn_cast< mlir::FileLineColLoc >()) {
+        if (auto resolved = resolver.resolve(loc)) {
+            ss << " : " << resolved->file << ":" << resolved->line << ":" << resolved->column;
+        } else if (auto file_loc = loc.template dyn_cast< mlir::FileLineColLoc >()) {
             ss << " : " << file_loc.getFilename().getValue() << ":" << file_loc.getLine()
                          << ":" << file_loc.getColumn();
         } else {
@@ -88,10 +93,10 @@ namespace vast::util
         return ss.str();
     }
 
-    std::string show_symbol_value(auto &value) {
+    std::string show_symbol_value(auto &value, meta::offset_resolver &resolver) {
         std::string buff;
         llvm::raw_string_ostream ss(buff);
-        ss << value->getName() << " : " << symbol_name(value) << " " << show_location(value);
+        ss << value->getName() << " : " << symbol_name(value) << " " << show_location(value, resolver);
         return ss.str();
     }
 
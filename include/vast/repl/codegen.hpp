@@ -12,7 +12,7 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "vast/repl/common.hpp"
-#include "vast/Translation/CodeGen.hpp"
+#include "vast/Translation/CodeGenIncremental.hpp"
 
 #include <filesystem>
 
@@ -25,4 +25,8 @@ namespace vast::repl::codegen {
 
     owning_module_ref emit_module(const std::string &source, MContext *ctx);
 
+    owning_module_ref emit_module(
+        const std::string &source, MContext *ctx, hl::incremental_state &incremental
+    );
+
 } // namespace vast::repl::codegen
@@ -53,14 +53,16 @@ namespace vast::repl
         struct string_param  { std::string value; };
         struct integer_param { std::uint64_t value; };
 
-        enum class show_kind { source, ast, module, symbols };
+        enum class show_kind { source, ast, module, locations, symbols, stats };
 
         template< typename enum_type >
         enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, show_kind >) {
-            if (token == "source")  return enum_type::source;
-            if (token == "ast")     return enum_type::ast;
-            if (token == "module")  return enum_type::module;
-            if (token == "symbols") return enum_type::symbols;
+            if (token == "source")    return enum_type::source;
+            if (token == "ast")       return enum_type::ast;
+            if (token == "module")    return enum_type::module;
+            if (token == "locations") return enum_type::locations;
+            if (token == "symbols")   return enum_type::symbols;
+            if (token == "stats")     return enum_type::stats;
             VAST_UNREACHABLE("uknnown show kind: {0}", token.str());
         }
 
@@ -220,7 +222,29 @@ namespace vast::repl
             params_storage params;
         };
 
-        using command_list = util::type_list< exit, help, load, show, meta >;
+        //
+        // symbol command
+        //
+        struct symbol : base {
+            static constexpr string_ref name() { return "symbol"; }
+
+            static constexpr inline char symbol_param[] = "symbol";
+
+            using command_params = util::type_list<
+                named_param< symbol_param, string_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            symbol(const params_storage &params) : params(params) {}
+            symbol(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        using command_list = util::type_list< exit, help, load, show, meta, symbol >;
 
     } // namespace command
 
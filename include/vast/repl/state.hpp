@@ -4,6 +4,9 @@
 
 #include "vast/repl/common.hpp"
 
+#include "vast/Bytecode/Bytecode.hpp"
+#include "vast/Translation/CodeGenIncremental.hpp"
+
 namespace vast::repl {
 
     using owning_module_ref = OwningModuleRef;
@@ -17,6 +20,13 @@ namespace vast::repl {
 
         MContext &ctx;
         owning_module_ref mod;
+
+        // module loaded from the vast bytecode, its symbols are materialized
+        // on demand until the whole module is needed
+        std::unique_ptr< bytecode::lazy_module > lazy;
+
+        // bodies of unchanged functions are reused when a source is reloaded
+        hl::incremental_state incremental;
     };
 
 } // namespace vast::repl
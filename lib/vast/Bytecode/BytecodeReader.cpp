@@ -0,0 +1,987 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
+#include <mlir/AsmParser/AsmParser.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinTypes.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Parser/Parser.h>
+#include <mlir/Support/FileUtilities.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Bytecode/Bytecode.hpp"
+#include "vast/Bytecode/BytecodeDialectInterface.hpp"
+
+#include "Encoding.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace vast::bytecode
+{
+    namespace detail
+    {
+        struct module_reader;
+
+        //
+        // Decoder of a single table entry handed to dialects.
+        //
+        struct entry_reader final : dialect_reader {
+            entry_reader(module_reader &module, cursor &in)
+                : module(module), in(in)
+            {}
+
+            mlir::MLIRContext *context() const override;
+
+            mlir::LogicalResult read_varint(std::uint64_t &value) override { return in.varint(value); }
+            mlir::LogicalResult read_signed_varint(std::int64_t &value) override { return in.signed_varint(value); }
+            mlir::LogicalResult read_apint(llvm::APInt &value) override { return in.apint(value); }
+
+            mlir::LogicalResult read_string(llvm::StringRef &value) override;
+            mlir::LogicalResult read_type(mlir::Type &type) override;
+            mlir::LogicalResult read_attribute(mlir::Attribute &attr) override;
+
+            using dialect_reader::read_varint;
+
+            module_reader &module;
+            cursor &in;
+        };
+
+        struct module_reader {
+            explicit module_reader(mlir::MLIRContext *mctx) : mctx(mctx) {}
+
+            mlir::LogicalResult error(const llvm::Twine &msg) {
+                mlir::emitError(mlir::UnknownLoc::get(mctx)) << "malformed vast bytecode: " << msg;
+                return mlir::failure();
+            }
+
+            //
+            // Sections
+            //
+            mlir::LogicalResult read_header(cursor &in) {
+                llvm::StringRef head;
+                std::uint64_t ver;
+                if (mlir::failed(in.raw(magic.size(), head)) || head != magic) {
+                    return error("missing magic");
+                }
+
+                if (mlir::failed(in.varint(ver)) || ver != version) {
+                    return error("unsupported version");
+                }
+
+                return mlir::success();
+            }
+
+            // Locates sections of the file and reads its tables.
+            mlir::LogicalResult read_sections(llvm::StringRef buffer) {
+                cursor in(buffer);
+                if (mlir::failed(read_header(in))) {
+                    return mlir::failure();
+                }
+
+                llvm::StringRef strings_section, types_section, attrs_section;
+                if (mlir::failed(in.blob(strings_section)) || mlir::failed(in.blob(types_section))
+                    || mlir::failed(in.blob(attrs_section)) || mlir::failed(in.blob(index_section))
+                    || mlir::failed(in.blob(ir_section)) || mlir::failed(in.blob(bodies_section))
+                    || !in.empty()
+                ) {
+                    return error("invalid sections");
+                }
+
+                cursor strings_in(strings_section), types_in(types_section), attrs_in(attrs_section);
+                if (mlir::failed(read_strings(strings_in))
+                    || mlir::failed(read_table(types_in, type_entries))
+                    || mlir::failed(read_table(attrs_in, attr_entries))
+                ) {
+                    return mlir::failure();
+                }
+
+                types.resize(type_entries.size());
+                attrs.resize(attr_entries.size());
+                return mlir::success();
+            }
+
+            mlir::LogicalResult read_index(std::vector< lazy_module::index_entry > &entries) {
+                cursor in(index_section);
+
+                std::uint64_t size;
+                if (mlir::failed(in.count(size))) {
+                    return error("invalid index");
+                }
+
+                entries.resize(size);
+                for (auto &entry : entries) {
+                    std::uint64_t offset, length;
+                    if (mlir::failed(string(in, entry.symbol))
+                        || mlir::failed(string(in, entry.operation))
+                        || mlir::failed(in.varint(entry.position))
+                        || mlir::failed(in.varint(offset))
+                        || mlir::failed(in.varint(length))
+                        || offset > bodies_section.size()
+                        || length > bodies_section.size() - offset
+                    ) {
+                        return error("invalid index entry");
+                    }
+
+                    entry.body = bodies_section.substr(offset, length);
+                }
+
+                return mlir::success();
+            }
+
+            mlir::LogicalResult read_strings(cursor &in) {
+                std::uint64_t size;
+                if (mlir::failed(in.count(size))) {
+                    return error("invalid string table");
+                }
+
+                strings.resize(size);
+                for (auto &str : strings) {
+                    if (mlir::failed(in.blob(str))) {
+                        return error("invalid string table");
+                    }
+                }
+
+                op_names.resize(size);
+                return mlir::success();
+            }
+
+            // Entries are only located here, they are decoded on first use.
+            mlir::LogicalResult read_table(cursor &in, std::vector< llvm::StringRef > &entries) {
+                std::uint64_t size;
+                if (mlir::failed(in.count(size))) {
+                    return error("invalid table");
+                }
+
+                entries.resize(size);
+                for (auto &entry : entries) {
+                    if (mlir::failed(in.blob(entry))) {
+                        return error("invalid table entry");
+                    }
+                }
+
+                return mlir::success();
+            }
+
+            mlir::LogicalResult string(cursor &in, llvm::StringRef &value) {
+                std::uint64_t idx;
+                if (mlir::failed(in.varint(idx)) || idx >= strings.size()) {
+                    return error("invalid string reference");
+                }
+
+                value = strings[idx];
+                return mlir::success();
+            }
+
+            //
+            // Types
+            //
+            mlir::LogicalResult type(cursor &in, mlir::Type &type) {
+                entry_ref ref;
+                if (mlir::failed(in.varint(ref)) || ref > type_entries.size()) {
+                    return error("invalid type reference");
+                }
+
+                if (ref == 0) {
+                    type = {};
+                    return mlir::success();
+                }
+
+                auto &cached = types[ref - 1];
+                if (!cached) {
+                    cursor entry(type_entries[ref - 1]);
+                    if (!(cached = decode_type(entry))) {
+                        return error("invalid type entry");
+                    }
+                }
+
+                type = cached;
+                return mlir::success();
+            }
+
+            // Reads a reference of a non-null type.
+            mlir::LogicalResult nonnull_type(cursor &in, mlir::Type &type) {
+                if (mlir::failed(this->type(in, type)) || !type) {
+                    return error("expected type");
+                }
+                return mlir::success();
+            }
+
+            mlir::Type decode_type(cursor &in) {
+                std::uint64_t kind;
+                if (mlir::failed(in.varint(kind))) {
+                    return {};
+                }
+
+                switch (type_entry(kind)) {
+                    case type_entry::text: {
+                        llvm::StringRef text;
+                        if (mlir::failed(string(in, text))) {
+                            return {};
+                        }
+                        return mlir::parseType(text, mctx);
+                    }
+                    case type_entry::dialect:
+                        return decode_with_dialect< mlir::Type >(in);
+                    case type_entry::integer: {
+                        std::uint64_t width, signedness;
+                        if (mlir::failed(in.varint(width)) || width > mlir::IntegerType::kMaxWidth
+                            || mlir::failed(in.varint(signedness)) || signedness > std::uint64_t(mlir::IntegerType::Unsigned)
+                        ) {
+                            return {};
+                        }
+                        return mlir::IntegerType::get(
+                            mctx, unsigned(width), mlir::IntegerType::SignednessSemantics(signedness)
+                        );
+                    }
+                    case type_entry::index:
+                        return mlir::IndexType::get(mctx);
+                    case type_entry::none:
+                        return mlir::NoneType::get(mctx);
+                    case type_entry::function: {
+                        llvm::SmallVector< mlir::Type > inputs, results;
+                        if (mlir::failed(types_list(in, inputs)) || mlir::failed(types_list(in, results))) {
+                            return {};
+                        }
+                        return mlir::FunctionType::get(mctx, inputs, results);
+                    }
+                }
+
+                error("unknown type kind");
+                return {};
+            }
+
+            mlir::LogicalResult types_list(cursor &in, llvm::SmallVectorImpl< mlir::Type > &list) {
+                std::uint64_t size;
+                if (mlir::failed(in.count(size))) {
+                    return mlir::failure();
+                }
+
+                list.resize(size);
+                for (auto &elem : list) {
+                    if (mlir::failed(nonnull_type(in, elem))) {
+                        return mlir::failure();
+                    }
+                }
+
+                return mlir::success();
+            }
+
+            //
+            // Attributes
+            //
+            mlir::LogicalResult attr(cursor &in, mlir::Attribute &attr) {
+                entry_ref ref;
+                if (mlir::failed(in.varint(ref)) || ref > attr_entries.size()) {
+                    return error("invalid attribute reference");
+                }
+
+                if (ref == 0) {
+                    attr = {};
+                    return mlir::success();
+                }
+
+                auto &cached = attrs[ref - 1];
+                if (!cached) {
+                    cursor entry(attr_entries[ref - 1]);
+                    if (!(cached = decode_attr(entry))) {
+                        return error("invalid attribute entry");
+                    }
+                }
+
+                attr = cached;
+                return mlir::success();
+            }
+
+            template< typename T >
+            mlir::LogicalResult attr(cursor &in, T &attr) {
+                mlir::Attribute raw;
+                if (mlir::failed(this->attr(in, raw))) {
+                    return mlir::failure();
+                }
+
+                attr = raw.dyn_cast_or_null< T >();
+                if (!attr) {
+                    return error("unexpected kind of attribute");
+                }
+                return mlir::success();
+            }
+
+            mlir::LogicalResult location(cursor &in, llvm::Optional< mlir::Location > &loc) {
+                mlir::LocationAttr attr;
+                if (mlir::failed(this->attr(in, attr))) {
+                    return mlir::failure();
+                }
+                loc = mlir::Location(attr);
+                return mlir::success();
+            }
+
+            mlir::Attribute decode_attr(cursor &in) {
+                std::uint64_t kind;
+                if (mlir::failed(in.varint(kind))) {
+                    return {};
+                }
+
+                switch (attr_entry(kind)) {
+                    case attr_entry::text: {
+                        llvm::StringRef text;
+                        if (mlir::failed(string(in, text))) {
+                            return {};
+                        }
+                        return mlir::parseAttribute(text, mctx);
+                    }
+                    case attr_entry::dialect:
+                        return decode_with_dialect< mlir::Attribute >(in);
+                    case attr_entry::string: {
+                        llvm::StringRef value;
+                        mlir::Type type;
+                        if (mlir::failed(string(in, value)) || mlir::failed(this->type(in, type))) {
+                            return {};
+                        }
+                        if (!type) {
+                            return mlir::StringAttr::get(mctx, value);
+                        }
+                        return mlir::StringAttr::get(value, type);
+                    }
+                    case attr_entry::integer: {
+                        mlir::Type type;
+                        llvm::APInt value;
+                        if (mlir::failed(nonnull_type(in, type)) || mlir::failed(in.apint(value))) {
+                            return {};
+                        }
+                        return mlir::IntegerAttr::get(type, value);
+                    }
+                    case attr_entry::type: {
+                        mlir::Type type;
+                        if (mlir::failed(nonnull_type(in, type))) {
+                            return {};
+                        }
+                        return mlir::TypeAttr::get(type);
+                    }
+                    case attr_entry::array: {
+                        std::uint64_t size;
+                        if (mlir::failed(in.count(size))) {
+                            return {};
+                        }
+                        llvm::SmallVector< mlir::Attribute > elements(size);
+                        for (auto &elem : elements) {
+                            if (mlir::failed(attr(in, elem)) || !elem) {
+                                return {};
+                            }
+                        }
+                        return mlir::ArrayAttr::get(mctx, elements);
+                    }
+                    case attr_entry::dictionary: {
+                        std::uint64_t size;
+                        if (mlir::failed(in.count(size))) {
+                            return {};
+                        }
+                        llvm::SmallVector< mlir::NamedAttribute > elements;
+                        elements.reserve(size);
+                        for (std::uint64_t i = 0; i < size; ++i) {
+                            llvm::StringRef name;
+                            mlir::Attribute value;
+                            if (mlir::failed(string(in, name)) || mlir::failed(attr(in, value)) || !value) {
+                                return {};
+                            }
+                            elements.emplace_back(mlir::StringAttr::get(mctx, name), value);
+                        }
+                        // dictionaries are written sorted
+                        return mlir::DictionaryAttr::getWithSorted(mctx, elements);
+                    }
+                    case attr_entry::unit:
+                        return mlir::UnitAttr::get(mctx);
+                    case attr_entry::symbol_ref: {
+                        llvm::StringRef root;
+                        std::uint64_t size;
+                        if (mlir::failed(string(in, root)) || mlir::failed(in.count(size))) {
+                            return {};
+                        }
+                        llvm::SmallVector< mlir::FlatSymbolRefAttr > nested;
+                        for (std::uint64_t i = 0; i < size; ++i) {
+                            llvm::StringRef name;
+                            if (mlir::failed(string(in, name))) {
+                                return {};
+                            }
+                            nested.push_back(mlir::FlatSymbolRefAttr::get(mctx, name));
+                        }
+                        return mlir::SymbolRefAttr::get(mlir::StringAttr::get(mctx, root), nested);
+                    }
+                    case attr_entry::unknown_loc:
+                        return mlir::UnknownLoc::get(mctx);
+                    case attr_entry::file_line_col_loc: {
+                        llvm::StringRef file;
+                        unsigned line, column;
+                        if (mlir::failed(string(in, file))
+                            || mlir::failed(entry_varint(in, line))
+                            || mlir::failed(entry_varint(in, column))
+                        ) {
+                            return {};
+                        }
+                        return mlir::FileLineColLoc::get(mctx, file, line, column);
+                    }
+                    case attr_entry::name_loc: {
+                        llvm::StringRef name;
+                        llvm::Optional< mlir::Location > child;
+                        if (mlir::failed(string(in, name)) || mlir::failed(location(in, child))) {
+                            return {};
+                        }
+                        return mlir::NameLoc::get(mlir::StringAttr::get(mctx, name), *child);
+                    }
+                    case attr_entry::call_site_loc: {
+                        llvm::Optional< mlir::Location > callee, caller;
+                        if (mlir::failed(location(in, callee)) || mlir::failed(location(in, caller))) {
+                            return {};
+                        }
+                        return mlir::CallSiteLoc::get(*callee, *caller);
+                    }
+                    case attr_entry::fused_loc: {
+                        std::uint64_t size;
+                        if (mlir::failed(in.count(size))) {
+                            return {};
+                        }
+                        llvm::SmallVector< mlir::Location > locs;
+                        for (std::uint64_t i = 0; i < size; ++i) {
+                            llvm::Optional< mlir::Location > loc;
+                            if (mlir::failed(location(in, loc))) {
+                                return {};
+                            }
+                            locs.push_back(*loc);
+                        }
+                        mlir::Attribute metadata;
+                        if (mlir::failed(attr(in, metadata))) {
+                            return {};
+                        }
+                        return mlir::FusedLoc::get(locs, metadata, mctx);
+                    }
+                }
+
+                error("unknown attribute kind");
+                return {};
+            }
+
+            mlir::LogicalResult entry_varint(cursor &in, unsigned &value) {
+                std::uint64_t raw;
+                if (mlir::failed(in.varint(raw)) || raw > std::numeric_limits< unsigned >::max()) {
+                    return mlir::failure();
+                }
+                value = unsigned(raw);
+                return mlir::success();
+            }
+
+            template< typename Entity >
+            Entity decode_with_dialect(cursor &in) {
+                llvm::StringRef name;
+                if (mlir::failed(string(in, name))) {
+                    return {};
+                }
+
+                auto dialect = mctx->getOrLoadDialect(name);
+                if (!dialect) {
+                    error("unknown dialect '" + name + "'");
+                    return {};
+                }
+
+                auto iface = dialect->getRegisteredInterface< BytecodeDialectInterface >();
+                if (!iface) {
+                    error("dialect '" + name + "' has no bytecode encoding");
+                    return {};
+                }
+
+                entry_reader reader(*this, in);
+                if constexpr (std::is_same_v< Entity, mlir::Type >) {
+                    return iface->read_type(reader);
+                } else {
+                    return iface->read_attribute(reader);
+                }
+            }
+
+            //
+            // Operations
+            //
+            mlir::LogicalResult operation_name(cursor &in, llvm::Optional< mlir::OperationName > &name) {
+                std::uint64_t idx;
+                if (mlir::failed(in.varint(idx)) || idx >= strings.size()) {
+                    return error("invalid operation name");
+                }
+
+                auto &cached = op_names[idx];
+                if (!cached) {
+                    auto str = strings[idx];
+                    // load the dialect first, so that the name gets registered
+                    auto [prefix, rest] = str.split('.');
+                    if (!rest.empty()) {
+                        mctx->getOrLoadDialect(prefix);
+                    }
+
+                    mlir::OperationName op_name(str, mctx);
+                    if (!op_name.isRegistered() && !mctx->allowsUnregisteredDialects()) {
+                        return error("unregistered operation '" + str + "'");
+                    }
+                    cached = op_name;
+                }
+
+                name = cached;
+                return mlir::success();
+            }
+
+            mlir::LogicalResult read_scope(cursor &in, llvm::function_ref< mlir::LogicalResult() > body) {
+                auto saved_values  = std::exchange(values, {});
+                auto saved_forward = std::exchange(forward, {});
+                auto saved_next    = std::exchange(next, 0);
+
+                std::uint64_t size;
+                if (mlir::failed(in.count(size))) {
+                    return error("invalid number of values");
+                }
+                values.resize(size);
+
+                auto result = body();
+                if (mlir::succeeded(result) && !forward.empty()) {
+                    result = error("use of an undefined value");
+                }
+
+                for (auto [id, placeholder] : forward) {
+                    dead_placeholders.push_back(placeholder);
+                }
+
+                values  = std::move(saved_values);
+                forward = std::move(saved_forward);
+                next    = saved_next;
+                return result;
+            }
+
+            mlir::LogicalResult define(mlir::Value value) {
+                auto id = next++;
+                if (id >= values.size()) {
+                    return error("too many values in scope");
+                }
+
+                if (auto it = forward.find(id); it != forward.end()) {
+                    auto placeholder = it->second;
+                    placeholder->getResult(0).replaceAllUsesWith(value);
+                    placeholder->destroy();
+                    forward.erase(it);
+                }
+
+                values[id] = value;
+                return mlir::success();
+            }
+
+            mlir::LogicalResult use(cursor &in, mlir::Value &value) {
+                std::uint64_t raw;
+                if (mlir::failed(in.varint(raw))) {
+                    return error("invalid value reference");
+                }
+
+                auto id = raw >> 1;
+                if (id >= values.size()) {
+                    return error("invalid value reference");
+                }
+
+                if (!(raw & 1)) {
+                    if (id >= next) {
+                        return error("use of an undefined value");
+                    }
+                    value = values[id];
+                    return mlir::success();
+                }
+
+                // forward reference, a placeholder is replaced once the
+                // value gets defined
+                mlir::Type type;
+                if (mlir::failed(nonnull_type(in, type)) || id < next) {
+                    return error("invalid forward reference");
+                }
+
+                auto &placeholder = forward[id];
+                if (!placeholder) {
+                    mlir::OpBuilder bld(mctx);
+                    placeholder = bld.create< mlir::UnrealizedConversionCastOp >(
+                        bld.getUnknownLoc(), type, mlir::ValueRange()
+                    );
+                }
+
+                value = placeholder->getResult(0);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult read_operation(cursor &in, mlir::Block *block) {
+                llvm::Optional< mlir::OperationName > name;
+                llvm::Optional< mlir::Location > loc;
+                mlir::Attribute dict;
+                if (mlir::failed(operation_name(in, name))
+                    || mlir::failed(location(in, loc))
+                    || mlir::failed(attr(in, dict))
+                ) {
+                    return mlir::failure();
+                }
+
+                auto attributes = dict.dyn_cast_or_null< mlir::DictionaryAttr >();
+                if (dict && !attributes) {
+                    return error("expected attribute dictionary");
+                }
+                if (!attributes) {
+                    attributes = mlir::DictionaryAttr::get(mctx);
+                }
+
+                llvm::SmallVector< mlir::Type, 2 > result_types;
+                if (mlir::failed(types_list(in, result_types))) {
+                    return error("invalid result types");
+                }
+
+                std::uint64_t num_operands;
+                if (mlir::failed(in.count(num_operands))) {
+                    return error("invalid number of operands");
+                }
+
+                llvm::SmallVector< mlir::Value, 4 > operands(num_operands);
+                for (auto &operand : operands) {
+                    if (mlir::failed(use(in, operand))) {
+                        return mlir::failure();
+                    }
+                }
+
+                std::uint64_t num_successors;
+                if (mlir::failed(in.count(num_successors))) {
+                    return error("invalid number of successors");
+                }
+
+                llvm::SmallVector< mlir::Block *, 2 > successors(num_successors);
+                for (auto &succ : successors) {
+                    std::uint64_t idx;
+                    if (mlir::failed(in.varint(idx)) || regions.empty() || idx >= regions.back().size()) {
+                        return error("invalid successor");
+                    }
+                    succ = regions.back()[idx];
+                }
+
+                std::uint64_t num_regions;
+                if (mlir::failed(in.count(num_regions))) {
+                    return error("invalid number of regions");
+                }
+
+                auto op = mlir::Operation::create(
+                    *loc, *name, result_types, operands, attributes, successors, unsigned(num_regions)
+                );
+                block->push_back(op);
+
+                for (auto res : op->getResults()) {
+                    if (mlir::failed(define(res))) {
+                        return mlir::failure();
+                    }
+                }
+
+                if (num_regions == 0) {
+                    return mlir::success();
+                }
+
+                std::uint64_t isolated;
+                if (mlir::failed(in.varint(isolated)) || isolated > 1) {
+                    return error("invalid region kind");
+                }
+
+                auto read_regions = [&] {
+                    for (auto &region : op->getRegions()) {
+                        if (mlir::failed(read_region(in, region))) {
+                            return mlir::failure();
+                        }
+                    }
+                    return mlir::success();
+                };
+
+                return isolated ? read_scope(in, read_regions) : read_regions();
+            }
+
+            mlir::LogicalResult read_region(cursor &in, mlir::Region &region) {
+                std::uint64_t num_blocks;
+                if (mlir::failed(in.count(num_blocks))) {
+                    return error("invalid number of blocks");
+                }
+
+                // blocks are created upfront, so that successors can refer to them
+                auto &blocks = regions.emplace_back();
+                for (std::uint64_t i = 0; i < num_blocks; ++i) {
+                    blocks.push_back(new mlir::Block());
+                    region.push_back(blocks.back());
+                }
+
+                auto result = read_blocks(in, blocks);
+                regions.pop_back();
+                return result;
+            }
+
+            mlir::LogicalResult read_blocks(cursor &in, llvm::ArrayRef< mlir::Block * > blocks) {
+                for (auto block : blocks) {
+                    std::uint64_t num_args;
+                    if (mlir::failed(in.count(num_args))) {
+                        return error("invalid number of block arguments");
+                    }
+
+                    for (std::uint64_t i = 0; i < num_args; ++i) {
+                        mlir::Type type;
+                        llvm::Optional< mlir::Location > loc;
+                        if (mlir::failed(nonnull_type(in, type)) || mlir::failed(location(in, loc))) {
+                            return mlir::failure();
+                        }
+
+                        if (mlir::failed(define(block->addArgument(type, *loc)))) {
+                            return mlir::failure();
+                        }
+                    }
+
+                    std::uint64_t num_ops;
+                    if (mlir::failed(in.count(num_ops))) {
+                        return error("invalid number of operations");
+                    }
+
+                    for (std::uint64_t i = 0; i < num_ops; ++i) {
+                        if (mlir::failed(read_operation(in, block))) {
+                            return mlir::failure();
+                        }
+                    }
+                }
+
+                return mlir::success();
+            }
+
+            mlir::Operation *read_root(cursor &in, mlir::Block &top) {
+                auto result = read_scope(in, [&] { return read_operation(in, &top); });
+
+                // placeholders of undefined values are released once their
+                // users are gone
+                auto root = top.empty() ? nullptr : &top.front();
+                if (mlir::failed(result) || !in.empty()) {
+                    if (mlir::succeeded(result)) {
+                        error("trailing bytes");
+                    }
+                    top.clear();
+                    root = nullptr;
+                } else {
+                    root->remove();
+                }
+
+                for (auto placeholder : dead_placeholders) {
+                    placeholder->getResult(0).dropAllUses();
+                    placeholder->destroy();
+                }
+                dead_placeholders.clear();
+
+                return root;
+            }
+
+            mlir::MLIRContext *mctx;
+
+            llvm::StringRef index_section, ir_section, bodies_section;
+
+            std::vector< llvm::StringRef > strings;
+            std::vector< llvm::Optional< mlir::OperationName > > op_names;
+
+            std::vector< llvm::StringRef > type_entries;
+            std::vector< mlir::Type > types;
+
+            std::vector< llvm::StringRef > attr_entries;
+            std::vector< mlir::Attribute > attrs;
+
+            // values of the current scope indexed by their ids
+            std::vector< mlir::Value > values;
+            llvm::DenseMap< std::uint64_t, mlir::Operation * > forward;
+            std::uint64_t next = 0;
+
+            std::vector< mlir::Operation * > dead_placeholders;
+
+            // blocks of enclosing regions, successors refer to the innermost
+            std::vector< std::vector< mlir::Block * > > regions;
+        };
+
+        mlir::MLIRContext *entry_reader::context() const { return module.mctx; }
+
+        mlir::LogicalResult entry_reader::read_string(llvm::StringRef &value) {
+            return module.string(in, value);
+        }
+
+        mlir::LogicalResult entry_reader::read_type(mlir::Type &type) {
+            return module.type(in, type);
+        }
+
+        mlir::LogicalResult entry_reader::read_attribute(mlir::Attribute &attr) {
+            return module.attr(in, attr);
+        }
+
+    } // namespace detail
+
+    bool is_bytecode(llvm::StringRef buffer) { return buffer.startswith(magic); }
+
+    owning_module_ref read_bytecode(llvm::StringRef buffer, mlir::MLIRContext *mctx) {
+        auto file = llvm::MemoryBuffer::getMemBuffer(buffer, "", /* RequiresNullTerminator */ false);
+        auto lazy = lazy_module::open(std::move(file), mctx);
+        if (!lazy || mlir::failed(lazy->materialize_all())) {
+            return nullptr;
+        }
+
+        return lazy->release();
+    }
+
+    //
+    // lazy module
+    //
+    lazy_module::lazy_module(std::unique_ptr< llvm::MemoryBuffer > buffer, mlir::MLIRContext *mctx)
+        : buffer(std::move(buffer)), reader(std::make_unique< detail::module_reader >(mctx))
+    {}
+
+    lazy_module::~lazy_module() = default;
+
+    std::unique_ptr< lazy_module > lazy_module::open(
+        std::unique_ptr< llvm::MemoryBuffer > buffer, mlir::MLIRContext *mctx
+    ) {
+        std::unique_ptr< lazy_module > lazy(new lazy_module(std::move(buffer), mctx));
+        if (mlir::failed(lazy->init())) {
+            return nullptr;
+        }
+        return lazy;
+    }
+
+    std::unique_ptr< lazy_module > lazy_module::open(llvm::StringRef path, mlir::MLIRContext *mctx) {
+        auto file = llvm::MemoryBuffer::getFile(
+            path, /* IsText */ false, /* RequiresNullTerminator */ false
+        );
+
+        if (auto ec = file.getError()) {
+            mlir::emitError(mlir::UnknownLoc::get(mctx))
+                << "cannot open '" << path << "': " << ec.message();
+            return nullptr;
+        }
+
+        return open(std::move(*file), mctx);
+    }
+
+    mlir::LogicalResult lazy_module::init() {
+        if (mlir::failed(reader->read_sections(buffer->getBuffer()))
+            || mlir::failed(reader->read_index(entries))
+        ) {
+            return mlir::failure();
+        }
+
+        mlir::Block top;
+        cursor in(reader->ir_section);
+        auto root = reader->read_root(in, top);
+        if (!root) {
+            return mlir::failure();
+        }
+
+        mod = mlir::dyn_cast< mlir::ModuleOp >(root);
+        if (!mod) {
+            root->emitError("expected a module");
+            root->destroy();
+            return mlir::failure();
+        }
+
+        for (auto &op : *mod->getBody()) {
+            shared.push_back(&op);
+        }
+
+        for (std::size_t idx = 0; idx < entries.size(); ++idx) {
+            const auto &entry = entries[idx];
+            if (entry.position > shared.size()) {
+                return reader->error("invalid position of '" + entry.symbol + "'");
+            }
+            by_symbol[entry.symbol].push_back(idx);
+        }
+
+        return mlir::verify(*mod);
+    }
+
+    mlir::LogicalResult lazy_module::materialize(index_entry &entry) {
+        if (entry.materialized()) {
+            return mlir::success();
+        }
+
+        mlir::Block top;
+        cursor in(entry.body);
+        auto op = reader->read_root(in, top);
+        if (!op) {
+            return mlir::failure();
+        }
+
+        // the symbol follows materialized symbols of the same position, or
+        // the shared operation preceding it
+        auto body = mod->getBody();
+        auto idx  = std::size_t(&entry - entries.data());
+
+        mlir::Operation *prev = nullptr;
+        for (auto i = idx; i > 0 && entries[i - 1].position == entry.position; --i) {
+            if ((prev = entries[i - 1].op)) {
+                break;
+            }
+        }
+
+        if (!prev && entry.position > 0) {
+            prev = shared[entry.position - 1];
+        }
+
+        body->getOperations().insert(prev ? std::next(prev->getIterator()) : body->begin(), op);
+        entry.op = op;
+        return mlir::success();
+    }
+
+    mlir::LogicalResult lazy_module::materialize(llvm::StringRef symbol) {
+        auto it = by_symbol.find(symbol);
+        if (it == by_symbol.end()) {
+            return mlir::success();
+        }
+
+        for (auto idx : it->second) {
+            auto &entry = entries[idx];
+            if (entry.materialized()) {
+                continue;
+            }
+
+            if (mlir::failed(materialize(entry)) || mlir::failed(mlir::verify(entry.op))) {
+                return mlir::failure();
+            }
+        }
+
+        return mlir::success();
+    }
+
+    mlir::LogicalResult lazy_module::materialize_all() {
+        for (auto &entry : entries) {
+            if (mlir::failed(materialize(entry))) {
+                return mlir::failure();
+            }
+        }
+
+        return mlir::verify(*mod);
+    }
+
+    owning_module_ref load_module(llvm::SourceMgr &mgr, mlir::MLIRContext *mctx) {
+        auto buffer = mgr.getMemoryBuffer(mgr.getMainFileID())->getBuffer();
+        if (is_bytecode(buffer)) {
+            return read_bytecode(buffer, mctx);
+        }
+
+        return mlir::parseSourceFile< mlir::ModuleOp >(mgr, mctx);
+    }
+
+    owning_module_ref load_module(llvm::StringRef path, mlir::MLIRContext *mctx) {
+        std::string err;
+        auto file = mlir::openInputFile(path, &err);
+        if (!file) {
+            mlir::emitError(mlir::UnknownLoc::get(mctx)) << err;
+            return nullptr;
+        }
+
+        llvm::SourceMgr mgr;
+        mgr.AddNewSourceBuffer(std::move(file), llvm::SMLoc());
+        return load_module(mgr, mctx);
+    }
+
+} // namespace vast::bytecode
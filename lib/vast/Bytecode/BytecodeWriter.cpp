@@ -0,0 +1,570 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinTypes.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/IR/SymbolTable.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Bytecode/Bytecode.hpp"
+#include "vast/Bytecode/BytecodeDialectInterface.hpp"
+#include "vast/Interfaces/SymbolInterface.hpp"
+
+#include "Encoding.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace vast::bytecode
+{
+    namespace
+    {
+        struct module_writer;
+
+        //
+        // Encoder of a single table entry handed to dialects.
+        //
+        struct entry_writer final : dialect_writer {
+            entry_writer(module_writer &module, byte_buffer &out)
+                : module(module), out(out)
+            {}
+
+            void write_varint(std::uint64_t value) override { out.varint(value); }
+            void write_signed_varint(std::int64_t value) override { out.signed_varint(value); }
+            void write_apint(const llvm::APInt &value) override { out.apint(value); }
+
+            void write_string(llvm::StringRef value) override;
+            void write_type(mlir::Type type) override;
+            void write_attribute(mlir::Attribute attr) override;
+
+            module_writer &module;
+            byte_buffer &out;
+        };
+
+        struct module_writer {
+            std::uint64_t string(llvm::StringRef value) {
+                auto [it, inserted] = string_ids.try_emplace(value, strings.size());
+                if (inserted) {
+                    strings.push_back(it->getKey());
+                }
+                return it->getValue();
+            }
+
+            entry_ref type(mlir::Type type) {
+                if (!type) {
+                    return 0;
+                }
+
+                if (auto it = type_ids.find(type); it != type_ids.end()) {
+                    return it->second;
+                }
+
+                // the slot is taken before nested entries are encoded
+                auto idx = types.size();
+                types.emplace_back();
+
+                byte_buffer entry;
+                encode(type, entry);
+                types[idx] = std::move(entry.data);
+                return type_ids[type] = idx + 1;
+            }
+
+            entry_ref attr(mlir::Attribute attr) {
+                if (!attr) {
+                    return 0;
+                }
+
+                // opaque locations refer to in-memory objects, only their
+                // fallback locations are kept
+                if (auto loc = attr.dyn_cast< mlir::OpaqueLoc >()) {
+                    return this->attr(loc.getFallbackLocation());
+                }
+
+                if (auto it = attr_ids.find(attr); it != attr_ids.end()) {
+                    return it->second;
+                }
+
+                auto idx = attrs.size();
+                attrs.emplace_back();
+
+                byte_buffer entry;
+                encode(attr, entry);
+                attrs[idx] = std::move(entry.data);
+                return attr_ids[attr] = idx + 1;
+            }
+
+            //
+            // Types
+            //
+            void encode(mlir::Type type, byte_buffer &out) {
+                auto kind = [&] (type_entry k) { out.varint(std::uint64_t(k)); };
+
+                if (auto ty = type.dyn_cast< mlir::IntegerType >()) {
+                    kind(type_entry::integer);
+                    out.varint(ty.getWidth());
+                    out.varint(ty.getSignedness());
+                } else if (type.isa< mlir::IndexType >()) {
+                    kind(type_entry::index);
+                } else if (type.isa< mlir::NoneType >()) {
+                    kind(type_entry::none);
+                } else if (auto ty = type.dyn_cast< mlir::FunctionType >()) {
+                    kind(type_entry::function);
+                    out.varint(ty.getNumInputs());
+                    for (auto in : ty.getInputs()) {
+                        out.varint(this->type(in));
+                    }
+                    out.varint(ty.getNumResults());
+                    for (auto res : ty.getResults()) {
+                        out.varint(this->type(res));
+                    }
+                } else if (!encode_with_dialect(type, out)) {
+                    kind(type_entry::text);
+                    out.varint(string(print(type)));
+                }
+            }
+
+            //
+            // Attributes
+            //
+            void encode(mlir::Attribute attr, byte_buffer &out) {
+                auto kind = [&] (attr_entry k) { out.varint(std::uint64_t(k)); };
+
+                if (auto a = attr.dyn_cast< mlir::StringAttr >()) {
+                    kind(attr_entry::string);
+                    out.varint(string(a.getValue()));
+                    // strings are untyped mostly
+                    auto type = a.getType();
+                    out.varint(type.isa< mlir::NoneType >() ? 0 : this->type(type));
+                } else if (auto a = attr.dyn_cast< mlir::IntegerAttr >()) {
+                    kind(attr_entry::integer);
+                    out.varint(type(a.getType()));
+                    out.apint(a.getValue());
+                } else if (auto a = attr.dyn_cast< mlir::TypeAttr >()) {
+                    kind(attr_entry::type);
+                    out.varint(type(a.getValue()));
+                } else if (auto a = attr.dyn_cast< mlir::ArrayAttr >()) {
+                    kind(attr_entry::array);
+                    out.varint(a.size());
+                    for (auto elem : a) {
+                        out.varint(this->attr(elem));
+                    }
+                } else if (auto a = attr.dyn_cast< mlir::DictionaryAttr >()) {
+                    kind(attr_entry::dictionary);
+                    out.varint(a.size());
+                    for (auto named : a) {
+                        out.varint(string(named.getName().getValue()));
+                        out.varint(this->attr(named.getValue()));
+                    }
+                } else if (attr.isa< mlir::UnitAttr >()) {
+                    kind(attr_entry::unit);
+                } else if (auto a = attr.dyn_cast< mlir::SymbolRefAttr >()) {
+                    kind(attr_entry::symbol_ref);
+                    out.varint(string(a.getRootReference().getValue()));
+                    out.varint(a.getNestedReferences().size());
+                    for (auto nested : a.getNestedReferences()) {
+                        out.varint(string(nested.getValue()));
+                    }
+                } else if (attr.isa< mlir::UnknownLoc >()) {
+                    kind(attr_entry::unknown_loc);
+                } else if (auto loc = attr.dyn_cast< mlir::FileLineColLoc >()) {
+                    kind(attr_entry::file_line_col_loc);
+                    out.varint(string(loc.getFilename().getValue()));
+                    out.varint(loc.getLine());
+                    out.varint(loc.getColumn());
+                } else if (auto loc = attr.dyn_cast< mlir::NameLoc >()) {
+                    kind(attr_entry::name_loc);
+                    out.varint(string(loc.getName().getValue()));
+                    out.varint(this->attr(loc.getChildLoc()));
+                } else if (auto loc = attr.dyn_cast< mlir::CallSiteLoc >()) {
+                    kind(attr_entry::call_site_loc);
+                    out.varint(this->attr(loc.getCallee()));
+                    out.varint(this->attr(loc.getCaller()));
+                } else if (auto loc = attr.dyn_cast< mlir::FusedLoc >()) {
+                    kind(attr_entry::fused_loc);
+                    out.varint(loc.getLocations().size());
+                    for (auto elem : loc.getLocations()) {
+                        out.varint(this->attr(elem));
+                    }
+                    out.varint(this->attr(loc.getMetadata()));
+                } else if (!encode_with_dialect(attr, out)) {
+                    kind(attr_entry::text);
+                    out.varint(string(print(attr)));
+                }
+            }
+
+            template< typename Entity >
+            bool encode_with_dialect(Entity entity, byte_buffer &out) {
+                auto &dialect = entity.getDialect();
+                auto iface = dialect.template getRegisteredInterface< BytecodeDialectInterface >();
+                if (!iface) {
+                    return false;
+                }
+
+                byte_buffer payload;
+                entry_writer writer(*this, payload);
+
+                mlir::LogicalResult result = mlir::failure();
+                if constexpr (std::is_same_v< Entity, mlir::Type >) {
+                    result = iface->write_type(entity, writer);
+                } else {
+                    result = iface->write_attribute(entity, writer);
+                }
+
+                if (mlir::failed(result)) {
+                    return false;
+                }
+
+                out.varint(std::uint64_t(dialect_entry< Entity >()));
+                out.varint(string(dialect.getNamespace()));
+                out.raw(payload.data);
+                return true;
+            }
+
+            template< typename Entity >
+            static auto dialect_entry() {
+                if constexpr (std::is_same_v< Entity, mlir::Type >)
+                    return type_entry::dialect;
+                else
+                    return attr_entry::dialect;
+            }
+
+            template< typename Entity >
+            static std::string print(Entity entity) {
+                std::string buffer;
+                llvm::raw_string_ostream os(buffer);
+                entity.print(os);
+                return os.str();
+            }
+
+            //
+            // Operations
+            //
+            // Values get ids in the order of definitions in their scope, that
+            // is the same for the writer and the reader: results of an
+            // operation, then arguments and operations of its regions.
+            //
+            static bool is_isolated(mlir::Operation *op) {
+                return op->hasTrait< mlir::OpTrait::IsIsolatedFromAbove >();
+            }
+
+            void number(mlir::Operation *op) {
+                for (auto res : op->getResults()) {
+                    values.try_emplace(res, values.size());
+                }
+
+                if (is_isolated(op)) {
+                    return;
+                }
+
+                for (auto &region : op->getRegions()) {
+                    number(region);
+                }
+            }
+
+            void number(mlir::Region &region) {
+                for (auto &block : region) {
+                    for (auto arg : block.getArguments()) {
+                        values.try_emplace(arg, values.size());
+                    }
+
+                    for (auto &op : block) {
+                        if (!is_detached(&op)) {
+                            number(&op);
+                        }
+                    }
+                }
+            }
+
+            void define(mlir::Value value) {
+                VAST_ASSERT(values.lookup(value) == defined);
+                ++defined;
+            }
+
+            void use(mlir::Value value, byte_buffer &out) {
+                auto it = values.find(value);
+                VAST_ASSERT(it != values.end());
+
+                auto id = it->second;
+                if (id < defined) {
+                    out.varint(id << 1);
+                } else {
+                    // forward references carry the type of the value
+                    out.varint(id << 1 | 1);
+                    out.varint(type(value.getType()));
+                }
+            }
+
+            void write_root(mlir::Operation *op, byte_buffer &out) {
+                number(op);
+                out.varint(values.size());
+                write(op, out);
+            }
+
+            // Regions of isolated operations start a new scope of values.
+            void write_isolated_regions(mlir::Operation *op, byte_buffer &out) {
+                auto saved_values  = std::exchange(values, {});
+                auto saved_defined = std::exchange(defined, 0);
+
+                for (auto &region : op->getRegions()) {
+                    number(region);
+                }
+
+                out.varint(values.size());
+                for (auto &region : op->getRegions()) {
+                    write(region, out);
+                }
+
+                values  = std::move(saved_values);
+                defined = saved_defined;
+            }
+
+            void write(mlir::Operation *op, byte_buffer &out) {
+                out.varint(string(op->getName().getStringRef()));
+                out.varint(attr(mlir::LocationAttr(op->getLoc())));
+
+                auto dict = op->getAttrDictionary();
+                out.varint(dict.empty() ? 0 : attr(dict));
+
+                out.varint(op->getNumResults());
+                for (auto type : op->getResultTypes()) {
+                    out.varint(this->type(type));
+                }
+
+                out.varint(op->getNumOperands());
+                for (auto operand : op->getOperands()) {
+                    use(operand, out);
+                }
+
+                out.varint(op->getNumSuccessors());
+                for (auto succ : op->getSuccessors()) {
+                    out.varint(block_ids.lookup(succ));
+                }
+
+                for (auto res : op->getResults()) {
+                    define(res);
+                }
+
+                out.varint(op->getNumRegions());
+                if (op->getNumRegions() == 0) {
+                    return;
+                }
+
+                auto isolated = is_isolated(op);
+                out.varint(isolated);
+                if (isolated) {
+                    write_isolated_regions(op, out);
+                } else {
+                    for (auto &region : op->getRegions()) {
+                        write(region, out);
+                    }
+                }
+            }
+
+            void write(mlir::Region &region, byte_buffer &out) {
+                std::uint64_t idx = 0;
+                for (auto &block : region) {
+                    block_ids[&block] = idx++;
+                }
+
+                out.varint(idx);
+                for (auto &block : region) {
+                    out.varint(block.getNumArguments());
+                    for (auto arg : block.getArguments()) {
+                        out.varint(type(arg.getType()));
+                        out.varint(attr(mlir::LocationAttr(arg.getLoc())));
+                        define(arg);
+                    }
+
+                    out.varint(block.getOperations().size() - num_detached(block));
+                    for (auto &op : block) {
+                        if (!is_detached(&op)) {
+                            write(&op, out);
+                        }
+                    }
+                }
+            }
+
+            //
+            // Index
+            //
+            static llvm::Optional< llvm::StringRef > symbol_name(mlir::Operation *op) {
+                if (auto symbol = mlir::dyn_cast< VastSymbolOpInterface >(op)) {
+                    return symbol.getSymbolName();
+                }
+                if (auto symbol = mlir::dyn_cast< mlir::SymbolOpInterface >(op)) {
+                    return symbol.getName();
+                }
+                return llvm::None;
+            }
+
+            // Only operations that neither use nor define values of the
+            // module can be decoded on their own.
+            static bool is_self_contained(mlir::Operation *op) {
+                if (op->getNumOperands() != 0 || !op->use_empty()) {
+                    return false;
+                }
+
+                if (is_isolated(op)) {
+                    return true;
+                }
+
+                auto result = op->walk([&] (mlir::Operation *nested) {
+                    for (auto operand : nested->getOperands()) {
+                        if (!op->isAncestor(operand.getParentRegion()->getParentOp())) {
+                            return mlir::WalkResult::interrupt();
+                        }
+                    }
+                    return mlir::WalkResult::advance();
+                });
+
+                return !result.wasInterrupted();
+            }
+
+            static bool has_body(mlir::Operation *op) {
+                return llvm::any_of(op->getRegions(), [] (auto &region) { return !region.empty(); });
+            }
+
+            // Selects top-level symbol definitions of the module for the index.
+            void detach(mlir::ModuleOp mod) {
+                detached_from = mod.getBody();
+
+                std::uint64_t position = 0;
+                for (auto &op : *detached_from) {
+                    auto name = symbol_name(&op);
+                    if (name && has_body(&op) && is_self_contained(&op)) {
+                        detached.insert(&op);
+                        index.push_back({ &op, *name, position });
+                    } else {
+                        ++position;
+                    }
+                }
+            }
+
+            bool is_detached(mlir::Operation *op) const {
+                return op->getBlock() == detached_from && detached.contains(op);
+            }
+
+            std::uint64_t num_detached(mlir::Block &block) const {
+                return &block == detached_from ? detached.size() : 0;
+            }
+
+            // Each symbol is encoded as a root of its own.
+            void write_bodies(byte_buffer &bodies) {
+                for (auto &entry : index) {
+                    auto saved_values  = std::exchange(values, {});
+                    auto saved_defined = std::exchange(defined, 0);
+
+                    entry.offset = bodies.size();
+                    write_root(entry.op, bodies);
+                    entry.size = bodies.size() - entry.offset;
+
+                    values  = std::move(saved_values);
+                    defined = saved_defined;
+                }
+            }
+
+            void write_index(byte_buffer &out) {
+                out.varint(index.size());
+                for (const auto &entry : index) {
+                    out.varint(string(entry.symbol));
+                    out.varint(string(entry.op->getName().getStringRef()));
+                    out.varint(entry.position);
+                    out.varint(entry.offset);
+                    out.varint(entry.size);
+                }
+            }
+
+            void finish(const byte_buffer &ir, const byte_buffer &bodies, llvm::raw_ostream &os) {
+                // the index may refer to new strings
+                byte_buffer index_section;
+                write_index(index_section);
+
+                byte_buffer file;
+                file.raw(magic);
+                file.varint(version);
+
+                byte_buffer section;
+                section.varint(strings.size());
+                for (auto str : strings) {
+                    section.blob(str);
+                }
+                file.blob(section.data);
+
+                auto table = [&] (const std::vector< std::string > &entries) {
+                    byte_buffer section;
+                    section.varint(entries.size());
+                    for (const auto &entry : entries) {
+                        section.blob(entry);
+                    }
+                    file.blob(section.data);
+                };
+
+                table(types);
+                table(attrs);
+                file.blob(index_section.data);
+
+                file.blob(ir.data);
+                file.blob(bodies.data);
+
+                os.write(file.data.data(), file.data.size());
+            }
+
+            llvm::StringMap< std::uint64_t > string_ids;
+            std::vector< llvm::StringRef > strings;
+
+            llvm::DenseMap< mlir::Type, entry_ref > type_ids;
+            std::vector< std::string > types;
+
+            llvm::DenseMap< mlir::Attribute, entry_ref > attr_ids;
+            std::vector< std::string > attrs;
+
+            llvm::DenseMap< mlir::Value, std::uint64_t > values;
+            std::uint64_t defined = 0;
+
+            llvm::DenseMap< mlir::Block *, std::uint64_t > block_ids;
+
+            struct index_entry {
+                mlir::Operation *op;
+                llvm::StringRef symbol;
+                std::uint64_t position;
+                std::uint64_t offset = 0;
+                std::uint64_t size = 0;
+            };
+
+            // top-level operations of the module that are written as bodies
+            mlir::Block *detached_from = nullptr;
+            llvm::DenseSet< mlir::Operation * > detached;
+            std::vector< index_entry > index;
+        };
+
+        void entry_writer::write_string(llvm::StringRef value) { out.varint(module.string(value)); }
+        void entry_writer::write_type(mlir::Type type) { out.varint(module.type(type)); }
+        void entry_writer::write_attribute(mlir::Attribute attr) { out.varint(module.attr(attr)); }
+
+    } // namespace
+
+    mlir::LogicalResult write_bytecode(mlir::Operation *op, llvm::raw_ostream &os) {
+        module_writer writer;
+        if (auto mod = mlir::dyn_cast< mlir::ModuleOp >(op)) {
+            writer.detach(mod);
+        }
+
+        byte_buffer ir, bodies;
+        writer.write_root(op, ir);
+        // strings and entries of the bodies end up in the shared tables
+        writer.write_bodies(bodies);
+        writer.finish(ir, bodies, os);
+
+        return mlir::success();
+    }
+
+} // namespace vast::bytecode
@@ -0,0 +1,158 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/LEB128.h>
+#include <mlir/Support/LogicalResult.h>
+VAST_UNRELAX_WARNINGS
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace vast::bytecode
+{
+    // Tags of table entries, they are part of the format, new kinds are
+    // appended only.
+    enum class type_entry : std::uint64_t {
+        text, dialect, integer, index, none, function
+    };
+
+    enum class attr_entry : std::uint64_t {
+        text, dialect,
+        string, integer, type, array, dictionary, unit, symbol_ref,
+        unknown_loc, file_line_col_loc, name_loc, call_site_loc, fused_loc
+    };
+
+    // References to table entries are offset by one, zero encodes null.
+    using entry_ref = std::uint64_t;
+
+    struct byte_buffer {
+        void varint(std::uint64_t value) {
+            std::uint8_t buffer[16];
+            auto size = llvm::encodeULEB128(value, buffer);
+            data.append(reinterpret_cast< const char * >(buffer), size);
+        }
+
+        void signed_varint(std::int64_t value) {
+            std::uint8_t buffer[16];
+            auto size = llvm::encodeSLEB128(value, buffer);
+            data.append(reinterpret_cast< const char * >(buffer), size);
+        }
+
+        // Length prefixed bytes.
+        void blob(llvm::StringRef bytes) {
+            varint(bytes.size());
+            data.append(bytes.begin(), bytes.end());
+        }
+
+        void raw(llvm::StringRef bytes) { data.append(bytes.begin(), bytes.end()); }
+
+        // The bit width followed by the value, wide integers word by word.
+        void apint(const llvm::APInt &value) {
+            varint(value.getBitWidth());
+            if (value.getBitWidth() <= 64) {
+                varint(value.getZExtValue());
+                return;
+            }
+
+            for (unsigned i = 0; i < value.getNumWords(); ++i) {
+                varint(value.getRawData()[i]);
+            }
+        }
+
+        std::size_t size() const { return data.size(); }
+
+        std::string data;
+    };
+
+    struct cursor {
+        explicit cursor(llvm::StringRef bytes)
+            : ptr(bytes.bytes_begin()), end(bytes.bytes_end())
+        {}
+
+        mlir::LogicalResult varint(std::uint64_t &value) {
+            unsigned size = 0;
+            const char *error = nullptr;
+            value = llvm::decodeULEB128(ptr, &size, end, &error);
+            ptr += size;
+            return mlir::success(!error);
+        }
+
+        mlir::LogicalResult signed_varint(std::int64_t &value) {
+            unsigned size = 0;
+            const char *error = nullptr;
+            value = llvm::decodeSLEB128(ptr, &size, end, &error);
+            ptr += size;
+            return mlir::success(!error);
+        }
+
+        // Reads a count of entities that take at least a byte each, so that
+        // malformed counts are rejected before anything is allocated.
+        mlir::LogicalResult count(std::uint64_t &value) {
+            return mlir::success(mlir::succeeded(varint(value)) && value <= remaining());
+        }
+
+        mlir::LogicalResult blob(llvm::StringRef &bytes) {
+            std::uint64_t size;
+            if (mlir::failed(varint(size)) || size > remaining()) {
+                return mlir::failure();
+            }
+
+            bytes = llvm::StringRef(reinterpret_cast< const char * >(ptr), size);
+            ptr += size;
+            return mlir::success();
+        }
+
+        mlir::LogicalResult raw(std::size_t size, llvm::StringRef &bytes) {
+            if (size > remaining()) {
+                return mlir::failure();
+            }
+
+            bytes = llvm::StringRef(reinterpret_cast< const char * >(ptr), size);
+            ptr += size;
+            return mlir::success();
+        }
+
+        mlir::LogicalResult apint(llvm::APInt &value) {
+            std::uint64_t width;
+            if (mlir::failed(varint(width)) || width > std::numeric_limits< unsigned >::max()) {
+                return mlir::failure();
+            }
+
+            auto bits = unsigned(width);
+            if (bits <= 64) {
+                std::uint64_t word;
+                if (mlir::failed(varint(word)) || (bits < 64 && word >> bits)) {
+                    return mlir::failure();
+                }
+                value = llvm::APInt(bits, word);
+                return mlir::success();
+            }
+
+            llvm::SmallVector< std::uint64_t, 4 > words(llvm::APInt::getNumWords(bits));
+            for (auto &word : words) {
+                if (mlir::failed(varint(word))) {
+                    return mlir::failure();
+                }
+            }
+
+            value = llvm::APInt(bits, words);
+            return mlir::success();
+        }
+
+        std::size_t remaining() const { return std::size_t(end - ptr); }
+
+        bool empty() const { return ptr == end; }
+
+        const std::uint8_t *ptr;
+        const std::uint8_t *end;
+    };
+
+} // namespace vast::bytecode
@@ -19,6 +19,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
@@ -307,6 +308,45 @@ namespace vast
             }
         };
 
+        // Value of a constant of the target type, as expected by LLVM constants
+        // and initializers of globals.
+        mlir::Attribute convert_constant_attr(mlir::Attribute attr, mlir::Type target_type,
+                                              const mlir::DataLayout &dl,
+                                              mlir::Builder &builder)
+        {
+            if (auto float_attr = attr.dyn_cast< hl::FloatAttr >())
+            {
+                // NOTE(lukas): We cannot simply forward the return value of `getValue()`
+                //              because it can have different semantics than one expected
+                //              by `FloatAttr`.
+                // TODO(lukas): Is there a better way to convert this?
+                //              Ideally `APFloat -> APFloat`.
+                double raw_value = float_attr.getValue().convertToDouble();
+                return builder.getFloatAttr(target_type, raw_value);
+            }
+            if (auto int_attr = attr.dyn_cast< hl::IntegerAttr >())
+            {
+                auto size = dl.getTypeSizeInBits(target_type);
+                auto coerced = int_attr.getValue().sextOrTrunc(size);
+                return builder.getIntegerAttr(target_type, coerced);
+            }
+            if (auto str_attr = attr.dyn_cast< hl::StringAttr >())
+            {
+                // The literal is padded by null characters to the size of the array.
+                auto array_type = target_type.dyn_cast< LLVM::LLVMArrayType >();
+                if (!array_type)
+                    return {};
+                auto data = str_attr.getValue().str();
+                data.resize(array_type.getNumElements(), '\0');
+                return builder.getStringAttr(data);
+            }
+            // Elements of dense constants already have widths of the target.
+            if (auto dense_attr = attr.dyn_cast< mlir::DenseElementsAttr >())
+                return dense_attr;
+            // Not implemented yet.
+            return {};
+        }
+
         struct constant_int : BasePattern< hl::ConstantOp >
         {
             using Base = BasePattern< hl::ConstantOp >;
@@ -316,49 +356,84 @@ namespace vast
                     hl::ConstantOp op, hl::ConstantOp::Adaptor ops,
                     mlir::ConversionPatternRewriter &rewriter) const override
             {
-                rewriter.replaceOp(op, {make_from(op, rewriter, this->type_converter())});
+                auto target_ty = this->type_converter().convert_type_to_type(op.getType());
+                VAST_PATTERN_CHECK(target_ty, "Could not convert constant type");
+
+                const auto &dl = this->type_converter().getDataLayoutAnalysis()
+                                                       ->getAtOrAbove(op);
+                auto attr = convert_constant_attr(op.getValue(), *target_ty, dl, rewriter);
+                if (!attr)
+                    return mlir::failure();
+
+                rewriter.replaceOpWithNewOp< LLVM::ConstantOp >(op, *target_ty, attr);
                 return mlir::success();
             }
+        };
+
+        struct dense_constant : BasePattern< hl::DenseConstantOp >
+        {
+            using op_t = hl::DenseConstantOp;
+            using Base = BasePattern< op_t >;
+            using Base::Base;
 
-            mlir::Attribute convert_attr(auto attr, auto op,
-                                         mlir::ConversionPatternRewriter &rewriter) const
+            mlir::LogicalResult matchAndRewrite(
+                    op_t op, typename op_t::Adaptor ops,
+                    mlir::ConversionPatternRewriter &rewriter) const override
             {
-                auto target_type = this->type_converter().convert_type_to_type(attr.getType());
-                const auto &dl = this->type_converter().getDataLayoutAnalysis()
-                                                       ->getAtOrAbove(op);
-                if (!target_type)
-                    return {};
+                auto target_ty = tc.convert_type_to_type(op.getType());
+                VAST_PATTERN_CHECK(target_ty, "Could not convert dense constant type");
 
-                if (auto float_attr = attr.template dyn_cast< hl::FloatAttr >())
-                {
-                    // NOTE(lukas): We cannot simply forward the return value of `getValue()`
-                    //              because it can have different semantics than one expected
-                    //              by `FloatAttr`.
-                    // TODO(lukas): Is there a better way to convert this?
-                    //              Ideally `APFloat -> APFloat`.
-                    double raw_value = float_attr.getValue().convertToDouble();
-                    return rewriter.getFloatAttr(*target_type, raw_value);
-                }
-                if (auto int_attr = attr.template dyn_cast< hl::IntegerAttr >())
-                {
-                    auto size = dl.getTypeSizeInBits(*target_type);
-                    auto coerced = int_attr.getValue().sextOrTrunc(size);
-                    return rewriter.getIntegerAttr(*target_type, coerced);
-                }
-                // Not implemented yet.
-                return {};
+                rewriter.replaceOpWithNewOp< LLVM::ConstantOp >(op, *target_ty, op.getValue());
+                return mlir::success();
             }
+        };
+
+        // Variables outside of functions initialized by a constant, see
+        // `hl::constant_global_initializer`. The constant becomes the initializer
+        // of the global, hence large tables are not stored element by element.
+        struct global_var : BasePattern< hl::VarDeclOp >
+        {
+            using op_t = hl::VarDeclOp;
+            using Base = BasePattern< op_t >;
+            using Base::Base;
 
-            LLVM::ConstantOp make_from(
-                    hl::ConstantOp op,
-                    mlir::ConversionPatternRewriter &rewriter,
-                    auto &&tc) const
+            mlir::LogicalResult matchAndRewrite(
+                    op_t op, typename op_t::Adaptor ops,
+                    mlir::ConversionPatternRewriter &rewriter) const override
             {
-                auto src_ty = op.getType();
-                auto target_ty = tc.convert_type_to_type(src_ty);
+                auto init = hl::constant_global_initializer(op);
+                if (!init)
+                    return mlir::failure();
+
+                mlir::Type type = op.getType();
+                if (auto lvalue = type.dyn_cast< hl::LValueType >())
+                    type = lvalue.getElementType();
+
+                auto target_ty = tc.convert_type_to_type(type);
+                VAST_PATTERN_CHECK(target_ty, "Could not convert global type");
 
-                auto attr = convert_attr(op.getValue(), op, rewriter);
-                return rewriter.create< LLVM::ConstantOp >(op.getLoc(), *target_ty, attr);
+                mlir::Attribute value;
+                if (auto constant = mlir::dyn_cast< hl::ConstantOp >(init))
+                    value = constant.getValue();
+                else
+                    value = mlir::cast< hl::DenseConstantOp >(init).getValue();
+
+                const auto &dl = tc.getDataLayoutAnalysis()->getAtOrAbove(op);
+                auto attr = convert_constant_attr(value, *target_ty, dl, rewriter);
+                if (!attr)
+                    return mlir::failure();
+
+                auto sc = op.getStorageClass();
+                auto linkage = sc && *sc == hl::StorageClass::sc_static
+                             ? LLVM::Linkage::Internal
+                             : LLVM::Linkage::External;
+
+                rewriter.create< LLVM::GlobalOp >(
+                        op.getLoc(), *target_ty, /* isConstant */ false, linkage,
+                        op.getName(), attr);
+                rewriter.eraseOp(op);
+
+                return mlir::success();
             }
         };
 
@@ -611,6 +686,8 @@ namespace vast
         patterns.add< pattern::scope >(type_converter);
         patterns.add< pattern::func_op >(type_converter);
         patterns.add< pattern::constant_int >(type_converter);
+        patterns.add< pattern::dense_constant >(type_converter);
+        patterns.add< pattern::global_var >(type_converter);
         patterns.add< pattern::ret >(type_converter);
         patterns.add< pattern::add >(type_converter);
         patterns.add< pattern::sub >(type_converter);
@@ -0,0 +1,368 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Bytecode/BytecodeDialectInterface.hpp"
+
+namespace vast::hl
+{
+    using bytecode::dialect_reader;
+    using bytecode::dialect_writer;
+
+    // Tags of encoded entities, they are part of the format, new kinds are
+    // appended only.
+    enum class type_kind : std::uint64_t {
+        void_type, bool_type,
+        char_type, short_type, int_type, long_type, longlong_type, int128_type,
+        half_type, bfloat16_type, float_type, double_type, longdouble_type, float128_type,
+        lvalue_type, pointer_type, array_type, decayed_type, paren_type,
+        record_type, enum_type, typedef_type, elaborated_type,
+        label_type, unsupported_type
+    };
+
+    enum class attr_kind : std::uint64_t {
+        boolean_attr, integer_attr, float_attr, string_attr, annotation_attr
+    };
+
+    //
+    // Qualifiers are packed into a single varint, the lowest bit marks
+    // presence of the qualifiers attribute.
+    //
+    static std::uint64_t flag(bool value, unsigned idx) { return std::uint64_t(value) << idx; }
+
+    static bool bit(std::uint64_t flags, unsigned idx) { return flags & flag(true, idx); }
+
+    static std::uint64_t pack(CVQualifiersAttr quals) {
+        if (!quals)
+            return 0;
+        return flag(true, 0) | flag(quals.getIsConst(), 1) | flag(quals.getIsVolatile(), 2);
+    }
+
+    static std::uint64_t pack(UCVQualifiersAttr quals) {
+        if (!quals)
+            return 0;
+        return flag(true, 0) | flag(quals.getIsConst(), 1) | flag(quals.getIsVolatile(), 2)
+             | flag(quals.getIsUnsigned(), 3);
+    }
+
+    static std::uint64_t pack(CVRQualifiersAttr quals) {
+        if (!quals)
+            return 0;
+        return flag(true, 0) | flag(quals.getIsConst(), 1) | flag(quals.getIsVolatile(), 2)
+             | flag(quals.getIsRestrict(), 3);
+    }
+
+    template< typename Quals >
+    static Quals unpack(mlir::MLIRContext *ctx, std::uint64_t flags) {
+        if (!bit(flags, 0))
+            return {};
+        if constexpr (std::is_same_v< Quals, CVQualifiersAttr >)
+            return Quals::get(ctx, bit(flags, 1), bit(flags, 2));
+        else if constexpr (std::is_same_v< Quals, UCVQualifiersAttr >)
+            return Quals::get(ctx, bit(flags, 3), bit(flags, 1), bit(flags, 2));
+        else
+            return Quals::get(ctx, bit(flags, 1), bit(flags, 2), bit(flags, 3));
+    }
+
+    template< typename T >
+    static T read_qualified(dialect_reader &reader) {
+        using quals_t = decltype(std::declval< T >().getQuals());
+        std::uint64_t flags;
+        if (mlir::failed(reader.read_varint(flags)))
+            return {};
+        auto ctx = reader.context();
+        return T::get(ctx, unpack< quals_t >(ctx, flags));
+    }
+
+    template< typename T, typename... Args >
+    static mlir::Type read_qualified_with(dialect_reader &reader, Args &&...args) {
+        using quals_t = decltype(std::declval< T >().getQuals());
+        std::uint64_t flags;
+        if (mlir::failed(reader.read_varint(flags)))
+            return {};
+        auto ctx = reader.context();
+        return T::get(ctx, std::forward< Args >(args)..., unpack< quals_t >(ctx, flags));
+    }
+
+    //
+    // HighLevelBytecodeInterface
+    //
+    struct HighLevelBytecodeInterface : bytecode::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        mlir::LogicalResult write_type(mlir::Type type, dialect_writer &writer) const override {
+            auto kind = [&] (type_kind k) { writer.write_varint(std::uint64_t(k)); };
+
+            auto qualified = [&] (type_kind k, auto ty) {
+                kind(k);
+                writer.write_varint(pack(ty.getQuals()));
+                return mlir::success();
+            };
+
+            auto element = [&] (type_kind k, auto ty) {
+                kind(k);
+                writer.write_type(ty.getElementType());
+                return mlir::success();
+            };
+
+            auto named = [&] (type_kind k, auto ty) {
+                kind(k);
+                writer.write_string(ty.getName());
+                writer.write_varint(pack(ty.getQuals()));
+                return mlir::success();
+            };
+
+            return llvm::TypeSwitch< mlir::Type, mlir::LogicalResult >(type)
+                .Case([&] (VoidType ty)       { return qualified(type_kind::void_type, ty); })
+                .Case([&] (BoolType ty)       { return qualified(type_kind::bool_type, ty); })
+                .Case([&] (CharType ty)       { return qualified(type_kind::char_type, ty); })
+                .Case([&] (ShortType ty)      { return qualified(type_kind::short_type, ty); })
+                .Case([&] (IntType ty)        { return qualified(type_kind::int_type, ty); })
+                .Case([&] (LongType ty)       { return qualified(type_kind::long_type, ty); })
+                .Case([&] (LongLongType ty)   { return qualified(type_kind::longlong_type, ty); })
+                .Case([&] (Int128Type ty)     { return qualified(type_kind::int128_type, ty); })
+                .Case([&] (HalfType ty)       { return qualified(type_kind::half_type, ty); })
+                .Case([&] (BFloat16Type ty)   { return qualified(type_kind::bfloat16_type, ty); })
+                .Case([&] (FloatType ty)      { return qualified(type_kind::float_type, ty); })
+                .Case([&] (DoubleType ty)     { return qualified(type_kind::double_type, ty); })
+                .Case([&] (LongDoubleType ty) { return qualified(type_kind::longdouble_type, ty); })
+                .Case([&] (Float128Type ty)   { return qualified(type_kind::float128_type, ty); })
+                .Case([&] (LValueType ty)     { return element(type_kind::lvalue_type, ty); })
+                .Case([&] (DecayedType ty)    { return element(type_kind::decayed_type, ty); })
+                .Case([&] (ParenType ty)      { return element(type_kind::paren_type, ty); })
+                .Case([&] (PointerType ty) {
+                    element(type_kind::pointer_type, ty);
+                    writer.write_varint(pack(ty.getQuals()));
+                    return mlir::success();
+                })
+                .Case([&] (ElaboratedType ty) {
+                    element(type_kind::elaborated_type, ty);
+                    writer.write_varint(pack(ty.getQuals()));
+                    return mlir::success();
+                })
+                .Case([&] (ArrayType ty) {
+                    element(type_kind::array_type, ty);
+                    // zero encodes an unknown size
+                    auto size = ty.getSize();
+                    writer.write_varint(size.hasValue() ? size.getValue() + 1 : 0);
+                    writer.write_varint(pack(ty.getQuals()));
+                    return mlir::success();
+                })
+                .Case([&] (RecordType ty)  { return named(type_kind::record_type, ty); })
+                .Case([&] (EnumType ty)    { return named(type_kind::enum_type, ty); })
+                .Case([&] (TypedefType ty) { return named(type_kind::typedef_type, ty); })
+                .Case([&] (LabelType) {
+                    kind(type_kind::label_type);
+                    return mlir::success();
+                })
+                .Case([&] (UnsupportedType ty) {
+                    kind(type_kind::unsupported_type);
+                    writer.write_string(ty.getName());
+                    return mlir::success();
+                })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        mlir::Type read_type(dialect_reader &reader) const override {
+            std::uint64_t kind;
+            if (mlir::failed(reader.read_varint(kind)))
+                return {};
+
+            auto ctx = reader.context();
+
+            auto element = [&] () -> mlir::Type {
+                mlir::Type type;
+                if (mlir::failed(reader.read_type(type)))
+                    return {};
+                return type;
+            };
+
+            auto name = [&] () -> llvm::Optional< llvm::StringRef > {
+                llvm::StringRef value;
+                if (mlir::failed(reader.read_string(value)))
+                    return llvm::None;
+                return value;
+            };
+
+            switch (type_kind(kind)) {
+                case type_kind::void_type:       return read_qualified< VoidType >(reader);
+                case type_kind::bool_type:       return read_qualified< BoolType >(reader);
+                case type_kind::char_type:       return read_qualified< CharType >(reader);
+                case type_kind::short_type:      return read_qualified< ShortType >(reader);
+                case type_kind::int_type:        return read_qualified< IntType >(reader);
+                case type_kind::long_type:       return read_qualified< LongType >(reader);
+                case type_kind::longlong_type:   return read_qualified< LongLongType >(reader);
+                case type_kind::int128_type:     return read_qualified< Int128Type >(reader);
+                case type_kind::half_type:       return read_qualified< HalfType >(reader);
+                case type_kind::bfloat16_type:   return read_qualified< BFloat16Type >(reader);
+                case type_kind::float_type:      return read_qualified< FloatType >(reader);
+                case type_kind::double_type:     return read_qualified< DoubleType >(reader);
+                case type_kind::longdouble_type: return read_qualified< LongDoubleType >(reader);
+                case type_kind::float128_type:   return read_qualified< Float128Type >(reader);
+                case type_kind::lvalue_type:
+                    if (auto elem = element())
+                        return LValueType::get(ctx, elem);
+                    return {};
+                case type_kind::decayed_type:
+                    if (auto elem = element())
+                        return DecayedType::get(ctx, elem);
+                    return {};
+                case type_kind::paren_type:
+                    if (auto elem = element())
+                        return ParenType::get(ctx, elem);
+                    return {};
+                case type_kind::pointer_type:
+                    if (auto elem = element())
+                        return read_qualified_with< PointerType >(reader, elem);
+                    return {};
+                case type_kind::elaborated_type:
+                    if (auto elem = element())
+                        return read_qualified_with< ElaboratedType >(reader, elem);
+                    return {};
+                case type_kind::array_type: {
+                    auto elem = element();
+                    std::uint64_t size;
+                    if (!elem || mlir::failed(reader.read_varint(size)))
+                        return {};
+                    auto param = size ? SizeParam(size - 1) : unknown_size;
+                    return read_qualified_with< ArrayType >(reader, param, elem);
+                }
+                case type_kind::record_type:
+                    if (auto value = name())
+                        return read_qualified_with< RecordType >(reader, *value);
+                    return {};
+                case type_kind::enum_type:
+                    if (auto value = name())
+                        return read_qualified_with< EnumType >(reader, *value);
+                    return {};
+                case type_kind::typedef_type:
+                    if (auto value = name())
+                        return read_qualified_with< TypedefType >(reader, *value);
+                    return {};
+                case type_kind::label_type:
+                    return LabelType::get(ctx);
+                case type_kind::unsupported_type:
+                    if (auto value = name())
+                        return UnsupportedType::get(ctx, *value);
+                    return {};
+            }
+
+            return {};
+        }
+
+        mlir::LogicalResult write_attribute(mlir::Attribute attr, dialect_writer &writer) const override {
+            auto kind = [&] (attr_kind k) { writer.write_varint(std::uint64_t(k)); };
+
+            return llvm::TypeSwitch< mlir::Attribute, mlir::LogicalResult >(attr)
+                .Case([&] (BooleanAttr a) {
+                    kind(attr_kind::boolean_attr);
+                    writer.write_type(a.getType());
+                    writer.write_bool(a.getValue());
+                    return mlir::success();
+                })
+                .Case([&] (IntegerAttr a) {
+                    kind(attr_kind::integer_attr);
+                    writer.write_type(a.getType());
+                    // keeps width and signedness, that the textual form drops
+                    writer.write_bool(a.getValue().isSigned());
+                    writer.write_apint(a.getValue());
+                    return mlir::success();
+                })
+                .Case([&] (FloatAttr a) {
+                    kind(attr_kind::float_attr);
+                    writer.write_type(a.getType());
+                    const auto &value = a.getValue();
+                    writer.write_varint(std::uint64_t(llvm::APFloat::SemanticsToEnum(value.getSemantics())));
+                    writer.write_apint(value.bitcastToAPInt());
+                    return mlir::success();
+                })
+                .Case([&] (StringAttr a) {
+                    kind(attr_kind::string_attr);
+                    writer.write_string(a.getValue());
+                    writer.write_type(a.getType());
+                    return mlir::success();
+                })
+                .Case([&] (AnnotationAttr a) {
+                    kind(attr_kind::annotation_attr);
+                    writer.write_attribute(a.getName());
+                    return mlir::success();
+                })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        mlir::Attribute read_attribute(dialect_reader &reader) const override {
+            std::uint64_t kind;
+            mlir::Type type;
+            if (mlir::failed(reader.read_varint(kind)))
+                return {};
+
+            switch (attr_kind(kind)) {
+                case attr_kind::boolean_attr: {
+                    bool value;
+                    if (mlir::failed(reader.read_type(type)) || !type || mlir::failed(reader.read_bool(value)))
+                        return {};
+                    return BooleanAttr::get(type, value);
+                }
+                case attr_kind::integer_attr: {
+                    bool is_signed;
+                    llvm::APInt value;
+                    if (mlir::failed(reader.read_type(type)) || !type
+                        || mlir::failed(reader.read_bool(is_signed))
+                        || mlir::failed(reader.read_apint(value))
+                    ) {
+                        return {};
+                    }
+                    return IntegerAttr::get(type, llvm::APSInt(value, !is_signed));
+                }
+                case attr_kind::float_attr: {
+                    std::uint64_t semantics;
+                    llvm::APInt bits;
+                    if (mlir::failed(reader.read_type(type)) || !type
+                        || mlir::failed(reader.read_varint(semantics))
+                        || semantics > std::uint64_t(llvm::APFloat::S_MaxSemantics)
+                        || mlir::failed(reader.read_apint(bits))
+                    ) {
+                        return {};
+                    }
+                    auto sem = llvm::APFloat::Semantics(semantics);
+                    auto &fltsem = llvm::APFloat::EnumToSemantics(sem);
+                    if (llvm::APFloat::getSizeInBits(fltsem) != bits.getBitWidth())
+                        return {};
+                    return FloatAttr::get(type, llvm::APFloat(fltsem, bits));
+                }
+                case attr_kind::string_attr: {
+                    llvm::StringRef value;
+                    if (mlir::failed(reader.read_string(value))
+                        || mlir::failed(reader.read_type(type)) || !type
+                    ) {
+                        return {};
+                    }
+                    return StringAttr::get(value, type);
+                }
+                case attr_kind::annotation_attr: {
+                    mlir::Attribute name;
+                    if (mlir::failed(reader.read_attribute(name)))
+                        return {};
+                    if (auto str = name.dyn_cast_or_null< mlir::StringAttr >())
+                        return AnnotationAttr::get(str);
+                    return {};
+                }
+            }
+
+            return {};
+        }
+    };
+
+    void HighLevelDialect::registerInterfaces() {
+        addInterfaces< HighLevelBytecodeInterface >();
+    }
+
+} // namespace vast::hl
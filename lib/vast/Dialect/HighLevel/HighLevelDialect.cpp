@@ -25,6 +25,7 @@ namespace vast::hl
     {
         registerTypes();
         registerAttributes();
+        registerInterfaces();
 
         addOperations<
             #define GET_OP_LIST
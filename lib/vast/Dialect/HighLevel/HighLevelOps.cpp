@@ -171,6 +171,11 @@ namespace vast::hl
         return getValue();
     }
 
+    FoldResult DenseConstantOp::fold(mlir::ArrayRef<Attribute> operands) {
+        VAST_CHECK(operands.empty(), "constant has no operands");
+        return getValue();
+    }
+
 
     void build_expr_trait(Builder &bld, State &st, Type rty, BuilderCallback expr) {
         VAST_ASSERT(expr && "the builder callback for 'expr' block must be present");
@@ -14,20 +14,22 @@ VAST_RELAX_WARNINGS
 
 namespace vast::hl
 {
-    Type LValueType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type>) const {
-        VAST_UNIMPLEMENTED;
+    // Sub-elements are replaced in the order of `walkImmediateSubElements`,
+    // qualifiers are not walked and are kept.
+    Type LValueType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type> tys) const {
+        return LValueType::get(getContext(), tys[0]);
     }
 
-    Type ElaboratedType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type>) const {
-        VAST_UNIMPLEMENTED;
+    Type ElaboratedType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type> tys) const {
+        return ElaboratedType::get(getContext(), tys[0], getQuals());
     }
 
-    Type PointerType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type>) const {
-        VAST_UNIMPLEMENTED;
+    Type PointerType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type> tys) const {
+        return PointerType::get(getContext(), tys[0], getQuals());
     }
 
-    Type ArrayType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type>) const {
-        VAST_UNIMPLEMENTED;
+    Type ArrayType::replaceImmediateSubElements(llvm::ArrayRef<mlir::Attribute>, llvm::ArrayRef<mlir::Type> tys) const {
+        return ArrayType::get(getContext(), getSize(), tys[0], getQuals());
     }
 
     Type getBottomTypedefType(TypedefType def, Module mod) {
@@ -5,6 +5,7 @@
 VAST_RELAX_WARNINGS
 #include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/SubElementInterfaces.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
@@ -532,6 +533,80 @@ namespace vast::hl
         }
     };
 
+    // Rewrites types of operations in place, without the conversion driver.
+    // The type converter lowers whole types where it can, the remaining
+    // types (e.g., elaborated ones) get their nested types replaced through
+    // `SubElementTypeInterface`. Results are cached for the whole module.
+    struct TypeReplacer
+    {
+        TypeConverter &tc;
+        AttributeConverter &ac;
+
+        llvm::DenseMap< mlir::Type, mlir::Type > types;
+        llvm::DenseMap< mlir::Attribute, mlir::Attribute > dicts;
+
+        // Converted types contain no high-level types, so the replacement
+        // does not change them any further.
+        mlir::Type convert(mlir::Type type)
+        {
+            if (!contains_hl_type(type))
+                return type;
+            if (auto converted = tc.convert_type_to_type(type))
+                return *converted;
+            return type;
+        }
+
+        mlir::Attribute convert(mlir::Attribute attr)
+        {
+            if (auto converted = ac.convertAttr(attr))
+                return *converted;
+            return attr;
+        }
+
+        auto convert_type_fn() { return [&](mlir::Type t) { return this->convert(t); }; }
+        auto convert_attr_fn() { return [&](mlir::Attribute a) { return this->convert(a); }; }
+
+        mlir::Type replace(mlir::Type type)
+        {
+            if (auto it = types.find(type); it != types.end())
+                return it->second;
+
+            auto replaced = convert(type);
+            if (replaced == type)
+                if (auto aggregate = type.dyn_cast< mlir::SubElementTypeInterface >())
+                    replaced = aggregate.replaceSubElements(convert_attr_fn(), convert_type_fn());
+
+            return types[type] = replaced;
+        }
+
+        mlir::DictionaryAttr replace(mlir::DictionaryAttr dict)
+        {
+            auto &replaced = dicts[dict];
+            if (!replaced)
+                replaced = dict.cast< mlir::SubElementAttrInterface >()
+                               .replaceSubElements(convert_attr_fn(), convert_type_fn());
+            return replaced.cast< mlir::DictionaryAttr >();
+        }
+
+        void lower(mlir::Operation *op)
+        {
+            for (auto res : op->getResults())
+                res.setType(replace(res.getType()));
+
+            for (auto &region : op->getRegions())
+                for (auto &block : region)
+                    for (auto arg : block.getArguments())
+                        arg.setType(replace(arg.getType()));
+
+            auto dict = op->getAttrDictionary();
+            if (dict.empty())
+                return;
+
+            if (auto lowered = replace(dict); lowered != dict)
+                op->setAttrs(lowered);
+        }
+    };
+
     struct HLLowerTypesPass : HLLowerTypesBase< HLLowerTypesPass >
     {
         void runOnOperation() override;
@@ -542,16 +617,28 @@ namespace vast::hl
         auto op = this->getOperation();
         auto &mctx = this->getContext();
 
+        const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
+        TypeConverter type_converter(dl_analysis.getAtOrAbove(op), mctx);
+        AttributeConverter attr_converter{mctx, type_converter};
+
+        if (!conversion_driver)
+        {
+            // The data layout of the module is keyed by high-level types,
+            // only nested operations are lowered.
+            TypeReplacer replacer{type_converter, attr_converter};
+            op->walk([&](mlir::Operation *nested) {
+                if (nested != op)
+                    replacer.lower(nested);
+            });
+            return;
+        }
+
         mlir::ConversionTarget trg(mctx);
         // We want to check *everything* for presence of hl type
         // that can be lowered.
         trg.markUnknownOpDynamicallyLegal(should_lower);
 
         mlir::RewritePatternSet patterns(&mctx);
-        const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
-        TypeConverter type_converter(dl_analysis.getAtOrAbove(op), mctx);
-        AttributeConverter attr_converter{mctx, type_converter};
-
         patterns.add< LowerGenericOpType,
                       LowerFuncOpType     >(type_converter, attr_converter,
                                             patterns.getContext());
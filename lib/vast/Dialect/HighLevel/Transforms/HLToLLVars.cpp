@@ -14,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 #include "PassesDetails.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "vast/Util/DialectConversion.hpp"
@@ -105,7 +106,10 @@ namespace vast::hl
 
             mlir::ConversionTarget trg(mctx);
             trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
-            trg.addIllegalOp< hl::VarDeclOp >();
+            // constant globals are lowered directly to initialized globals
+            trg.addDynamicallyLegalOp< hl::VarDeclOp >([] (hl::VarDeclOp op) {
+                return hl::constant_global_initializer(op) != nullptr;
+            });
 
             const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
 
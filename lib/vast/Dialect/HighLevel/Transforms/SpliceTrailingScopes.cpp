@@ -0,0 +1,24 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+
+namespace vast::hl
+{
+    struct HLSpliceTrailingScopesPass : HLSpliceTrailingScopesBase< HLSpliceTrailingScopesPass >
+    {
+        void runOnOperation() override
+        {
+            splice_trailing_scopes(this->getOperation());
+        }
+    };
+}
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLSpliceTrailingScopesPass()
+{
+    return std::make_unique< vast::hl::HLSpliceTrailingScopesPass >();
+}
@@ -3,8 +3,11 @@
 #include "vast/Dialect/Meta/MetaAttributes.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <mlir/IR/Builders.h>
+#include <mlir/IR/Location.h>
 #include <mlir/IR/OpImplementation.h>
 #include <mlir/IR/DialectImplementation.h>
 VAST_RELAX_WARNINGS
@@ -22,4 +25,63 @@ namespace vast::meta
         >();
     }
 
-} // namespace vast::hl
+    mlir::Location make_offset_location(mlir::StringAttr file, unsigned offset) {
+        return mlir::FileLineColLoc::get(file, 0, offset);
+    }
+
+    std::optional< unsigned > get_offset(mlir::Location loc) {
+        if (auto file = loc.dyn_cast< mlir::FileLineColLoc >()) {
+            if (file.getLine() == 0) {
+                return file.getColumn();
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional< resolved_location > offset_resolver::resolve(mlir::Location loc) {
+        auto offset = get_offset(loc);
+        if (!offset) {
+            return std::nullopt;
+        }
+
+        auto file = loc.cast< mlir::FileLineColLoc >().getFilename().getValue();
+        const auto &offsets = lines(file);
+        if (offsets.empty()) {
+            return std::nullopt;
+        }
+
+        auto next = llvm::upper_bound(offsets, *offset);
+        auto line = static_cast< unsigned >(std::distance(offsets.begin(), next));
+        return resolved_location{ file.str(), line, *offset - offsets[line - 1] + 1 };
+    }
+
+    const std::vector< unsigned > &offset_resolver::lines(llvm::StringRef file) {
+        auto [it, inserted] = files.try_emplace(file);
+        auto &offsets = it->second;
+        if (!inserted) {
+            return offsets;
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(file, /* IsText */ false, /* RequiresNullTerminator */ false);
+        if (!buffer) {
+            return offsets;
+        }
+
+        // the same line breaks as the clang source manager recognizes
+        auto data = (*buffer)->getBuffer();
+        offsets.push_back(0);
+        for (unsigned i = 0, size = unsigned(data.size()); i < size; ++i) {
+            if (data[i] == '\n') {
+                offsets.push_back(i + 1);
+            } else if (data[i] == '\r') {
+                if (i + 1 < size && data[i + 1] == '\n') {
+                    ++i;
+                }
+                offsets.push_back(i + 1);
+            }
+        }
+
+        return offsets;
+    }
+
+} // namespace vast::meta
@@ -0,0 +1,67 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Bytecode/BytecodeDialectInterface.hpp"
+
+namespace vast::meta
+{
+    using bytecode::dialect_reader;
+    using bytecode::dialect_writer;
+
+    enum class attr_kind : std::uint64_t {
+        identifier_attr
+    };
+
+    //
+    // MetaBytecodeInterface
+    //
+    // Identifiers are attached to most operations, hence they are stored as
+    // varints instead of their textual form.
+    //
+    struct MetaBytecodeInterface : bytecode::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        mlir::LogicalResult write_attribute(mlir::Attribute attr, dialect_writer &writer) const override {
+            auto kind = [&] (attr_kind k) { writer.write_varint(std::uint64_t(k)); };
+
+            return llvm::TypeSwitch< mlir::Attribute, mlir::LogicalResult >(attr)
+                .Case([&] (IdentifierAttr a) {
+                    kind(attr_kind::identifier_attr);
+                    writer.write_varint(a.getValue());
+                    return mlir::success();
+                })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        mlir::Attribute read_attribute(dialect_reader &reader) const override {
+            std::uint64_t kind;
+            if (mlir::failed(reader.read_varint(kind)))
+                return {};
+
+            auto ctx = reader.context();
+            switch (attr_kind(kind)) {
+                case attr_kind::identifier_attr: {
+                    identifier_t id;
+                    if (mlir::failed(reader.read_varint(id)))
+                        return {};
+                    return IdentifierAttr::get(ctx, id);
+                }
+            }
+
+            return {};
+        }
+    };
+
+    void MetaDialect::registerInterfaces() {
+        addInterfaces< MetaBytecodeInterface >();
+    }
+
+} // namespace vast::meta
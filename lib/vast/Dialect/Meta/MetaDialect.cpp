@@ -10,6 +10,7 @@ namespace vast::meta
     void MetaDialect::initialize() {
         registerTypes();
         registerAttributes();
+        registerInterfaces();
 
         addOperations<
             #define GET_OP_LIST
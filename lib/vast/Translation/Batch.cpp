@@ -0,0 +1,274 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/ToolOutputFile.h>
+#include <llvm/Support/xxhash.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/Support/FileUtilities.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/Batch.hpp"
+#include "vast/Util/Common.hpp"
+
+#include "FromSource.hpp"
+#include "ModuleCache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace vast::hl
+{
+    static llvm::cl::opt< std::string > compile_commands(
+        "compile-commands",
+        llvm::cl::desc("Lift all translation units of a compilation database"),
+        llvm::cl::value_desc("compile_commands.json")
+    );
+
+    static llvm::cl::opt< std::string > output_dir(
+        "output-dir",
+        llvm::cl::desc("Directory for modules emitted by batch translation"),
+        llvm::cl::init(".")
+    );
+
+    static llvm::cl::opt< unsigned > jobs(
+        "jobs",
+        llvm::cl::desc("Number of batch translation workers (0 uses all cores)"),
+        llvm::cl::init(0)
+    );
+
+    using clock = std::chrono::steady_clock;
+
+    struct batch_unit {
+        clang::tooling::CompileCommand cmd;
+        // absolute path of the main source file
+        std::string file;
+        // path of the emitted module, unique in the batch
+        std::string output;
+        uint64_t size = 0;
+    };
+
+    struct batch_result {
+        bool ok = false;
+        std::string message;
+        double millis = 0;
+    };
+
+    static std::string absolute_path(llvm::StringRef dir, llvm::StringRef file) {
+        if (llvm::sys::path::is_absolute(file))
+            return file.str();
+
+        llvm::SmallString< 256 > path(dir);
+        llvm::sys::path::append(path, file);
+        llvm::sys::path::remove_dots(path, /* remove_dot_dot */ true);
+        return path.str().str();
+    }
+
+    static std::vector< std::string > unit_arguments(const batch_unit &unit) {
+        namespace tooling = clang::tooling;
+
+        const auto &cmd = unit.cmd;
+        auto adjust = tooling::combineAdjusters(
+            tooling::getClangStripOutputAdjuster(),
+            tooling::getClangStripDependencyFileAdjuster()
+        );
+
+        auto line = adjust(cmd.CommandLine, cmd.Filename);
+
+        // Relative paths of the command are resolved against the directory of
+        // the command, not against the working directory of the batch process.
+        std::vector< std::string > args = { "-working-directory=" + cmd.Directory };
+
+        // drop the compiler executable and the main file, clang tooling
+        // provides them on its own
+        for (const auto &arg : llvm::drop_begin(line)) {
+            if (arg != cmd.Filename && arg != unit.file) {
+                args.push_back(arg);
+            }
+        }
+
+        for (auto &&opt : compiler_options()) {
+            args.push_back(std::move(opt));
+        }
+
+        return args;
+    }
+
+    // Modules of a file compiled by several commands (e.g., with different
+    // macros) are distinguished by a hash of the command line.
+    static std::string output_path(const batch_unit &unit, bool disambiguate = false) {
+        llvm::SmallString< 256 > path(output_dir.getValue());
+        llvm::sys::path::append(path, llvm::sys::path::relative_path(unit.file));
+        if (disambiguate) {
+            path += "." + llvm::utohexstr(llvm::xxHash64(llvm::join(unit.cmd.CommandLine, " ")));
+        }
+        path += module_file_extension();
+        return path.str().str();
+    }
+
+    static batch_result lift(const batch_unit &unit, MContext &mctx) {
+        auto source = llvm::MemoryBuffer::getFile(unit.file);
+        if (!source) {
+            return { false, "cannot read source: " + source.getError().message() };
+        }
+
+        if (unit.cmd.CommandLine.empty()) {
+            return { false, "empty compile command" };
+        }
+
+        const auto &path = unit.output;
+        if (auto ec = llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+            return { false, "cannot create output directory: " + ec.message() };
+        }
+
+        std::string err;
+        auto out = mlir::openOutputFile(path, &err);
+        if (!out) {
+            return { false, err };
+        }
+
+        auto code = (*source)->getBuffer();
+        if (mlir::failed(emit_module(code, unit_arguments(unit), unit.file, &mctx, out->os()))) {
+            return { false, "clang reported errors" };
+        }
+
+        out->keep();
+
+        return { true, path };
+    }
+
+    static std::vector< batch_unit > load_units(llvm::StringRef path, std::string &err) {
+        auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+            path, err, clang::tooling::JSONCommandLineSyntax::AutoDetect
+        );
+
+        if (!db) {
+            return {};
+        }
+
+        // identical commands of a file are lifted once
+        llvm::StringSet<> commands;
+        // workers must never write the same output
+        llvm::StringSet<> outputs;
+
+        std::vector< batch_unit > units;
+        for (auto &cmd : db->getAllCompileCommands()) {
+            batch_unit unit{ .cmd = cmd, .file = absolute_path(cmd.Directory, cmd.Filename) };
+
+            auto command = unit.file + '\0' + cmd.Directory + '\0' + llvm::join(cmd.CommandLine, " ");
+            if (!commands.insert(command).second) {
+                llvm::errs() << "warning: skipping duplicate compile command of " << unit.file << "\n";
+                continue;
+            }
+
+            unit.output = output_path(unit);
+            if (!outputs.insert(unit.output).second) {
+                unit.output = output_path(unit, /* disambiguate */ true);
+                if (!outputs.insert(unit.output).second) {
+                    llvm::errs() << "error: conflicting output path " << unit.output
+                                 << " of " << unit.file << "\n";
+                    continue;
+                }
+
+                llvm::errs() << "warning: multiple compile commands of " << unit.file
+                             << ", emitting to " << unit.output << "\n";
+            }
+
+            // unreadable files keep zero size and fail later with a proper message
+            llvm::sys::fs::file_size(unit.file, unit.size);
+            units.push_back(std::move(unit));
+        }
+
+        // schedule the largest units first to shorten the tail of the batch
+        llvm::stable_sort(units, [] (const auto &a, const auto &b) {
+            return a.size > b.size;
+        });
+
+        return units;
+    }
+
+    static void report(const batch_unit &unit, const batch_result &result) {
+        auto status = result.ok ? "ok" : "failed";
+        llvm::errs() << llvm::formatv("[{0}] {1,10:F1} ms {2}", status, result.millis, unit.file);
+        if (!result.ok) {
+            llvm::errs() << ": " << result.message;
+        }
+        llvm::errs() << "\n";
+    }
+
+    bool is_batch_translation(int argc, char **argv) {
+        for (int i = 1; i < argc; ++i) {
+            auto arg = llvm::StringRef(argv[i]).ltrim('-');
+            if (arg.startswith(compile_commands.ArgStr)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    mlir::LogicalResult run_batch_translation(int argc, char **argv) {
+        llvm::cl::ParseCommandLineOptions(argc, argv, "VAST batch translation\n");
+
+        std::string err;
+        auto units = load_units(compile_commands, err);
+        if (!err.empty()) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        std::vector< batch_result > results(units.size());
+        std::atomic_size_t next = 0;
+        std::mutex report_mutex;
+
+        auto worker = [&] {
+            // every worker owns its context, so workers never synchronize on
+            // type or attribute uniquing
+            MContext mctx(MContext::Threading::DISABLED);
+
+            for (auto i = next++; i < units.size(); i = next++) {
+                auto start = clock::now();
+                auto result = lift(units[i], mctx);
+                result.millis = std::chrono::duration< double, std::milli >(
+                    clock::now() - start
+                ).count();
+
+                std::lock_guard lock(report_mutex);
+                report(units[i], result);
+                results[i] = std::move(result);
+            }
+        };
+
+        llvm::ThreadPool pool(llvm::hardware_concurrency(jobs));
+        for (unsigned i = 0; i < pool.getThreadCount(); ++i) {
+            pool.async(worker);
+        }
+        pool.wait();
+
+        if (auto cache = module_cache::get()) {
+            cache->finish();
+        }
+
+        auto failures = llvm::count_if(results, [] (const auto &res) { return !res.ok; });
+        llvm::errs() << llvm::formatv(
+            "lifted {0} of {1} translation units\n", units.size() - failures, units.size()
+        );
+
+        return mlir::success(failures == 0);
+    }
+
+} // namespace vast::hl
@@ -1,7 +1,80 @@
 // Copyright (c) 2022-present, Trail of Bits, Inc.
 
 #include "vast/Translation/CodeGen.hpp"
+#include "vast/Translation/CodeGenDriver.hpp"
+
+#include <variant>
 
 namespace vast::hl
 {
+    template< codegen_meta meta >
+    struct meta_generator;
+
+    template<>
+    struct meta_generator< codegen_meta::locations > { using type = DefaultMetaGenerator; };
+
+    template<>
+    struct meta_generator< codegen_meta::identifiers > { using type = IDMetaGenerator; };
+
+    template<>
+    struct meta_generator< codegen_meta::compact_locations > { using type = CompactMetaGenerator; };
+
+    template< codegen_meta meta >
+    struct CodeGenDriver< meta >::impl {
+        using meta_type = typename meta_generator< meta >::type;
+
+        using default_codegen  = DefaultCodeGen< DefaultCodeGenVisitorConfig, meta_type >;
+        using tolerant_codegen = DefaultCodeGen< TolerantCodeGenVisitorConfig, meta_type >;
+        using codegen_variant  = std::variant< default_codegen, tolerant_codegen >;
+
+        impl(AContext *actx, MContext *mctx, codegen_options opts)
+            : codegen(make(actx, mctx, std::move(opts)))
+        {}
+
+        // generators refer to their meta generators, hence they are built in place
+
+        static codegen_variant make(AContext *actx, MContext *mctx, codegen_options opts) {
+            if (opts.tolerate_unsupported) {
+                return codegen_variant(std::in_place_index< 1 >, actx, mctx, std::move(opts));
+            }
+            return codegen_variant(std::in_place_index< 0 >, actx, mctx, std::move(opts));
+        }
+
+        decltype(auto) apply(auto &&fn) { return std::visit(fn, codegen); }
+
+        codegen_variant codegen;
+    };
+
+    template< codegen_meta meta >
+    CodeGenDriver< meta >::CodeGenDriver(AContext *actx, MContext *mctx, codegen_options opts)
+        : _impl(std::make_unique< impl >(actx, mctx, std::move(opts)))
+    {}
+
+    template< codegen_meta meta >
+    CodeGenDriver< meta >::~CodeGenDriver() = default;
+
+    template< codegen_meta meta >
+    OwningModuleRef CodeGenDriver< meta >::emit_module(clang::ASTUnit *unit) {
+        return _impl->apply([&] (auto &codegen) { return codegen.emit_module(unit); });
+    }
+
+    template< codegen_meta meta >
+    OwningModuleRef CodeGenDriver< meta >::emit_module(clang::Decl *decl) {
+        return _impl->apply([&] (auto &codegen) { return codegen.emit_module(decl); });
+    }
+
+    template< codegen_meta meta >
+    void CodeGenDriver< meta >::append_to_module(clang::Decl *decl) {
+        _impl->apply([&] (auto &codegen) { codegen.append_to_module(decl); });
+    }
+
+    template< codegen_meta meta >
+    OwningModuleRef CodeGenDriver< meta >::freeze() {
+        return _impl->apply([] (auto &codegen) { return codegen.freeze(); });
+    }
+
+    template struct CodeGenDriver< codegen_meta::locations >;
+    template struct CodeGenDriver< codegen_meta::identifiers >;
+    template struct CodeGenDriver< codegen_meta::compact_locations >;
+
 } // namespace vast::hl
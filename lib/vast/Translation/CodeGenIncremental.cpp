@@ -0,0 +1,157 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ODRHash.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Lex/Lexer.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/xxhash.h>
+#include <mlir/IR/Location.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/CodeGenIncremental.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        //
+        // Collects types of expressions and declarations of a body. Types are not
+        // part of the odr hash, but they end up in the emitted body, as well as
+        // their sizes in the data layout. Locations of macro expansions are not
+        // tracked, so bodies that contain them are never reused.
+        //
+        struct used_types : clang::RecursiveASTVisitor< used_types > {
+            explicit used_types(AContext &actx) : actx(actx) {}
+
+            bool VisitStmt(clang::Stmt *stmt) {
+                has_macros |= stmt->getBeginLoc().isMacroID() || stmt->getEndLoc().isMacroID();
+                return !has_macros;
+            }
+
+            bool VisitExpr(clang::Expr *expr) {
+                add(expr->getType());
+                return true;
+            }
+
+            bool VisitValueDecl(clang::ValueDecl *decl) {
+                add(decl->getType());
+                return true;
+            }
+
+            void add(clang::QualType type) {
+                auto [it, inserted] = hashes.try_emplace(type.getAsOpaquePtr(), 0);
+                if (inserted) {
+                    it->second = hash(type);
+                }
+
+                summary += std::to_string(it->second);
+                summary += ';';
+            }
+
+            uint64_t hash(clang::QualType type) const {
+                auto repr = type.getAsString();
+                if (!type->isIncompleteType() && type->isConstantSizeType() && !type->isFunctionType()) {
+                    repr += ":" + std::to_string(actx.getTypeSize(type));
+                }
+                return llvm::xxHash64(repr);
+            }
+
+            AContext &actx;
+            llvm::DenseMap< void *, uint64_t > hashes;
+            std::string summary;
+            bool has_macros = false;
+        };
+
+    } // namespace
+
+    std::optional< body_fingerprint > fingerprint(const clang::FunctionDecl *decl, AContext &actx) {
+        const auto &sm = actx.getSourceManager();
+
+        auto range = decl->getSourceRange();
+        if (range.getBegin().isMacroID() || range.getEnd().isMacroID()) {
+            return std::nullopt;
+        }
+
+        auto begin = clang::FullSourceLoc(range.getBegin(), sm);
+        if (!begin.getFileEntry()) {
+            return std::nullopt;
+        }
+
+        auto text = clang::Lexer::getSourceText(
+            clang::CharSourceRange::getTokenRange(range), sm, actx.getLangOpts()
+        );
+
+        clang::ODRHash odr;
+        odr.AddQualType(decl->getType());
+        for (auto param : decl->parameters()) {
+            odr.AddDeclarationName(param->getDeclName());
+        }
+        odr.AddStmt(decl->getBody());
+
+        used_types types(actx);
+        types.TraverseStmt(decl->getBody());
+        for (auto param : decl->parameters()) {
+            types.add(param->getType());
+        }
+
+        if (types.has_macros) {
+            return std::nullopt;
+        }
+
+        // columns of the first line are not part of the text
+        std::string repr = std::to_string(odr.CalculateHash())
+            + ";" + std::to_string(begin.getColumnNumber())
+            + ";" + types.summary
+            + ";" + text.str();
+
+        return body_fingerprint{
+            .hash   = llvm::xxHash64(repr),
+            .file   = begin.getFileEntry()->getName().str(),
+            .line   = begin.getLineNumber(),
+            .lines  = static_cast< unsigned >(text.count('\n')),
+            .layout = {}
+        };
+    }
+
+    void shift_locations(mlir::Region &region, string_ref file, unsigned from, unsigned lines, int delta) {
+        if (delta == 0) {
+            return;
+        }
+
+        auto shift = [&] (mlir::Location loc) -> mlir::Location {
+            auto flc = loc.dyn_cast< mlir::FileLineColLoc >();
+            if (!flc || flc.getFilename() != file) {
+                return loc;
+            }
+
+            auto line = flc.getLine();
+            if (line < from || line > from + lines) {
+                return loc;
+            }
+
+            return mlir::FileLineColLoc::get(
+                flc.getFilename(), static_cast< unsigned >(int(line) + delta), flc.getColumn()
+            );
+        };
+
+        auto shift_arguments = [&] (mlir::Region &nested) {
+            for (auto &block : nested) {
+                for (auto arg : block.getArguments()) {
+                    arg.setLoc(shift(arg.getLoc()));
+                }
+            }
+        };
+
+        shift_arguments(region);
+        region.walk([&] (Operation *op) {
+            op->setLoc(shift(op->getLoc()));
+            for (auto &nested : op->getRegions()) {
+                shift_arguments(nested);
+            }
+        });
+    }
+
+} // namespace vast::hl
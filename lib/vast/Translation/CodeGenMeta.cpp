@@ -0,0 +1,201 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Mangle.h>
+#include <clang/AST/ParentMapContext.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Index/USRGeneration.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/CodeGenMeta.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        meta::identifier_t hash(std::initializer_list< std::uint64_t > parts) {
+            return llvm::xxHash64(llvm::StringRef(
+                reinterpret_cast< const char * >(parts.begin()), parts.size() * sizeof(std::uint64_t)
+            ));
+        }
+
+        bool is_local(const clang::Decl *decl) {
+            return decl->getParentFunctionOrMethod() != nullptr;
+        }
+
+        // The outermost declaration that is not local to a function.
+        const clang::Decl *owner(const clang::Decl *decl) {
+            while (auto dc = decl->getParentFunctionOrMethod()) {
+                decl = clang::Decl::castFromDeclContext(dc);
+            }
+            return decl;
+        }
+
+        //
+        // Numbers local nodes of a declaration in the order of traversal, that
+        // is given by the structure of the declaration. Nested declarations
+        // that are not local have their own identifiers.
+        //
+        struct local_nodes : clang::RecursiveASTVisitor< local_nodes > {
+            using base = clang::RecursiveASTVisitor< local_nodes >;
+
+            explicit local_nodes(const clang::Decl *root) : root(root) {}
+
+            bool shouldVisitImplicitCode() const { return true; }
+
+            bool TraverseDecl(clang::Decl *decl) {
+                if (decl && decl != root && !is_local(decl)) {
+                    return true;
+                }
+                return base::TraverseDecl(decl);
+            }
+
+            bool VisitDecl(clang::Decl *decl) { return add(decl), true; }
+            bool VisitStmt(clang::Stmt *stmt) { return add(stmt), true; }
+
+            void add(const void *node) { order.try_emplace(node, order.size()); }
+
+            const clang::Decl *root;
+            llvm::DenseMap< const void *, std::uint64_t > order;
+        };
+
+    } // namespace
+
+    meta::identifier_t IDMetaGenerator::identifier(const clang::Decl *decl) {
+        auto top = owner(decl);
+        auto id  = owner_identifier(top);
+        if (top == decl) {
+            return id;
+        }
+
+        if (auto it = nodes.find(decl); it != nodes.end()) {
+            return it->second;
+        }
+
+        return ordinal_identifier(decl, id, decl->getDeclKindName());
+    }
+
+    meta::identifier_t IDMetaGenerator::identifier(const clang::Stmt *stmt) {
+        // statements are emitted as parts of declarations, that are usually
+        // identified together with their nodes
+        if (auto it = nodes.find(stmt); it != nodes.end()) {
+            return it->second;
+        }
+
+        auto parent    = enclosing_decl(stmt);
+        auto parent_id = parent ? identifier(parent) : 0;
+        if (auto it = nodes.find(stmt); it != nodes.end()) {
+            return it->second;
+        }
+
+        return ordinal_identifier(stmt, parent_id, stmt->getStmtClassName());
+    }
+
+    meta::identifier_t IDMetaGenerator::identifier(clang::QualType type) {
+        auto canonical = type.getCanonicalType();
+        auto key = canonical.getAsOpaquePtr();
+        if (auto it = types.find(key); it != types.end()) {
+            return it->second;
+        }
+
+        // spellings of distinct types may coincide, e.g., of local records
+        llvm::SmallString< 128 > name;
+        if (clang::index::generateUSRForType(canonical, *actx, name)) {
+            name.clear();
+            llvm::raw_svector_ostream os(name);
+            mangler().mangleTypeName(canonical, os);
+        }
+
+        auto id = llvm::xxHash64(name);
+        types.try_emplace(key, id);
+        return id;
+    }
+
+    meta::identifier_t IDMetaGenerator::owner_identifier(const clang::Decl *owner) {
+        if (auto it = owners.find(owner); it != owners.end()) {
+            return it->second;
+        }
+
+        llvm::SmallString< 128 > usr;
+        auto id = clang::index::generateUSRForDecl(owner, usr)
+            ? sibling_identifier(owner)
+            : llvm::xxHash64(usr);
+
+        owners.try_emplace(owner, id);
+
+        local_nodes locals(owner);
+        locals.TraverseDecl(const_cast< clang::Decl * >(owner));
+        for (auto [node, position] : locals.order) {
+            nodes.try_emplace(node, hash({ id, position + 1 }));
+        }
+
+        return id;
+    }
+
+    // Fallback for declarations without USRs, e.g., static assertions. They
+    // are identified by their parent and their ordinal among its declarations
+    // of the same kind, that do not change by edits of other kinds of code.
+    meta::identifier_t IDMetaGenerator::sibling_identifier(const clang::Decl *decl) {
+        auto kind = llvm::xxHash64(decl->getDeclKindName());
+
+        auto dc = decl->getLexicalDeclContext();
+        if (!dc) {
+            return hash({ kind });
+        }
+
+        std::uint64_t ordinal = 0;
+        for (auto sibling : dc->decls()) {
+            if (sibling == decl) {
+                break;
+            }
+            if (sibling->getKind() == decl->getKind()) {
+                ++ordinal;
+            }
+        }
+
+        auto parent = clang::Decl::castFromDeclContext(dc);
+        return hash({ owner_identifier(owner(parent)), kind, ordinal });
+    }
+
+    // Fallback for local nodes that the traversal of their owner does not
+    // reach, e.g., nodes of types. They are numbered by the order of queries
+    // under their parent.
+    meta::identifier_t IDMetaGenerator::ordinal_identifier(
+        const void *node, meta::identifier_t parent, llvm::StringRef kind
+    ) {
+        auto kind_id = llvm::xxHash64(kind);
+        auto id = hash({ parent, kind_id, ordinals[{ parent, kind_id }]++ });
+        nodes.try_emplace(node, id);
+        return id;
+    }
+
+    const clang::Decl *IDMetaGenerator::enclosing_decl(const clang::Stmt *stmt) {
+        auto &parents = actx->getParentMapContext();
+        auto node = clang::DynTypedNode::create(*stmt);
+        while (true) {
+            auto candidates = parents.getParents(node);
+            if (candidates.empty()) {
+                return nullptr;
+            }
+
+            if (auto decl = candidates[0].get< clang::Decl >()) {
+                return decl;
+            }
+
+            node = candidates[0];
+        }
+    }
+
+    clang::MangleContext &IDMetaGenerator::mangler() {
+        if (!mangle_context) {
+            mangle_context.reset(actx->createMangleContext());
+        }
+        return *mangle_context;
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,74 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Tools/mlir-translate/Translation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "FromSource.hpp"
+
+namespace vast::hl
+{
+    static std::unique_ptr< clang::ASTUnit > load_ast_file(llvm::StringRef path) {
+        auto diags = clang::CompilerInstance::createDiagnostics(new clang::DiagnosticOptions());
+        auto pch   = std::make_shared< clang::PCHContainerOperations >();
+
+        return clang::ASTUnit::LoadFromASTFile(
+            path.str(), pch->getRawReader(), clang::ASTUnit::LoadEverything,
+            diags, clang::FileSystemOptions()
+        );
+    }
+
+    static OwningModuleRef from_ast_parser(
+        const llvm::MemoryBuffer *input, mlir::MLIRContext *mctx
+    ) {
+        // clang reads serialized ast through its file manager, hence the input
+        // has to be a file on disk, not just a buffer (e.g., stdin)
+        auto path = input->getBufferIdentifier();
+        if (!llvm::sys::fs::exists(path)) {
+            llvm::errs() << "error: ast input has to be a file: " << path << "\n";
+            return nullptr;
+        }
+
+        auto unit = load_ast_file(path);
+        if (!unit) {
+            llvm::errs() << "error: cannot load clang ast from " << path << "\n";
+            return nullptr;
+        }
+
+        return emit_module(unit.get(), mctx);
+    }
+
+    mlir::LogicalResult registerFromASTParser() {
+        // registered as a generic translation, so that the module can be
+        // written in the bytecode
+        mlir::TranslateRegistration from_ast(
+            "from-ast",
+            [](llvm::SourceMgr &mgr, llvm::raw_ostream &os, mlir::MLIRContext *ctx) {
+                VAST_CHECK(mgr.getNumBuffers() == 1,    "expected single input buffer");
+                auto buffer = mgr.getMemoryBuffer(mgr.getMainFileID());
+                auto mod = from_ast_parser(buffer, ctx);
+                if (!mod || mlir::failed(mlir::verify(*mod))) {
+                    return mlir::failure();
+                }
+
+                return print_module(mod, os);
+            });
+
+        return mlir::success();
+    }
+
+} // namespace vast::hl
@@ -9,7 +9,9 @@ VAST_RELAX_WARNINGS
 #include <clang/Frontend/FrontendAction.h>
 #include <clang/Tooling/Tooling.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/FormatVariadic.h>
 #include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Regex.h>
 #include <llvm/Support/SourceMgr.h>
 #include <mlir/Dialect/DLTI/DLTI.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
@@ -20,17 +22,26 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/Location.h>
 #include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/Verifier.h>
 #include <mlir/Support/LLVM.h>
 #include <mlir/Support/LogicalResult.h>
 #include <mlir/Tools/mlir-translate/Translation.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Bytecode/Bytecode.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
-#include "vast/Translation/CodeGen.hpp"
+#include "vast/Translation/CodeGenAction.hpp"
+#include "vast/Translation/CodeGenDriver.hpp"
 #include "vast/Util/Common.hpp"
 
+#include "FromSource.hpp"
+#include "ModuleCache.hpp"
+#include "ModuleStream.hpp"
+
+#include <memory>
+
 namespace vast::hl
 {
     static llvm::cl::list< std::string > compiler_args(
@@ -41,29 +52,366 @@ namespace vast::hl
         "id-meta", llvm::cl::desc("Attach ids to nodes as metadata")
     );
 
-    static OwningModuleRef from_source_parser(
-        const llvm::MemoryBuffer *input, mlir::MLIRContext *mctx
-    ) {
-        auto ast = clang::tooling::buildASTFromCodeWithArgs(
-            input->getBuffer(), compiler_args
+    static llvm::cl::opt< bool > parallel_bodies_flag(
+        "parallel-bodies", llvm::cl::desc("Emit function bodies in parallel")
+    );
+
+    static llvm::cl::opt< bool > main_file_only_flag(
+        "main-file-only", llvm::cl::desc(
+            "Emit only declarations of the main file, referenced declarations "
+            "of headers are emitted without definitions"
+        )
+    );
+
+    // Rejects invalid regular expressions when the command line is parsed.
+    struct regex_parser : llvm::cl::parser< std::string > {
+        using llvm::cl::parser< std::string >::parser;
+
+        bool parse(
+            llvm::cl::Option &opt, llvm::StringRef /* name */, llvm::StringRef arg, std::string &value
+        ) {
+            std::string error;
+            if (!llvm::Regex(arg).isValid(error)) {
+                return opt.error("invalid regex '" + arg + "': " + error);
+            }
+
+            value = arg.str();
+            return false;
+        }
+    };
+
+    static llvm::cl::opt< std::string, false, regex_parser > emit_filter(
+        "emit-filter", llvm::cl::desc(
+            "Emit also declarations of headers whose path matches the regex "
+            "(implies --main-file-only)"
+        ),
+        llvm::cl::value_desc("regex")
+    );
+
+    static llvm::cl::opt< bool > signatures_only_flag(
+        "signatures-only", llvm::cl::desc(
+            "Emit only function prototypes, globals without initializers and types"
+        )
+    );
+
+    static llvm::cl::opt< bool > stream_definitions_flag(
+        "stream-definitions", llvm::cl::desc(
+            "Write function definitions as soon as they are emitted and release "
+            "them, to bound memory of large translation units"
+        )
+    );
+
+    static llvm::cl::opt< bool > type_cache_stats_flag(
+        "type-cache-stats", llvm::cl::desc("Report hit rate of the type cache of the codegen")
+    );
+
+    static llvm::cl::opt< bool > no_type_cache_flag(
+        "no-type-cache", llvm::cl::desc(
+            "Translate types on each use, to compare with the cached translation"
+        ),
+        llvm::cl::Hidden
+    );
+
+    static llvm::cl::opt< bool > compact_locations_flag(
+        "compact-locations", llvm::cl::desc(
+            "Attach byte offsets of source ranges instead of lines and columns, "
+            "lines are resolved from sources when queried"
+        )
+    );
+
+    static llvm::cl::opt< bool > fold_constants_flag(
+        "fold-constants", llvm::cl::desc(
+            "Emit integer constant expressions as single constants"
+        )
+    );
+
+    static llvm::cl::opt< bool > tolerate_unsupported_flag(
+        "tolerate-unsupported", llvm::cl::desc(
+            "Emit placeholders of unsupported statements, declarations and "
+            "types instead of aborting, and report their counts"
+        )
+    );
+
+    static llvm::cl::opt< bool > emit_bytecode_flag(
+        "emit-bytecode", llvm::cl::desc(
+            "Write the module in the vast bytecode instead of the textual form"
+        )
+    );
+
+    std::vector< std::string > compiler_options() {
+        return { compiler_args.begin(), compiler_args.end() };
+    }
+
+    static bool filter_enabled() {
+        return main_file_only_flag || !emit_filter.empty();
+    }
+
+    static bool emit_declaration(const clang::Decl *decl, const llvm::Regex *filter) {
+        const auto &sm = decl->getASTContext().getSourceManager();
+
+        // implicit declarations have no location, they are emitted when referenced
+        auto loc = sm.getExpansionLoc(decl->getLocation());
+        if (loc.isInvalid()) {
+            return false;
+        }
+
+        if (sm.isInMainFile(loc)) {
+            return true;
+        }
+
+        return filter && filter->match(sm.getFilename(loc));
+    }
+
+    static codegen_options generator_options() {
+        codegen_options opts{ .parallel_bodies = parallel_bodies_flag };
+
+        if (filter_enabled()) {
+            // the regex is validated by the option parser, it is built for
+            // each invocation, so that it follows the current option value
+            std::shared_ptr< const llvm::Regex > filter;
+            if (!emit_filter.empty()) {
+                filter = std::make_shared< const llvm::Regex >(emit_filter);
+            }
+
+            opts.decl_filter = [filter] (const clang::Decl *decl) {
+                return emit_declaration(decl, filter.get());
+            };
+        }
+
+        opts.signatures_only = signatures_only_flag;
+        opts.fold_constants  = fold_constants_flag;
+        opts.type_cache      = !no_type_cache_flag;
+        opts.tolerate_unsupported = tolerate_unsupported_flag;
+        return opts;
+    }
+
+    // Options that change the emitted module, they are part of cache keys.
+    static std::string generator_options_id() {
+        std::string id = id_meta_flag ? "id-meta"
+                       : compact_locations_flag ? "compact-meta"
+                       : "default-meta";
+        if (filter_enabled()) {
+            id += ";main-file-only;" + emit_filter.getValue();
+        }
+        if (signatures_only_flag) {
+            id += ";signatures-only";
+        }
+        if (fold_constants_flag) {
+            id += ";fold-constants";
+        }
+        if (tolerate_unsupported_flag) {
+            id += ";tolerate-unsupported";
+        }
+        // the output is the same, but a cached module must not stand in for
+        // the uncached translation
+        if (no_type_cache_flag) {
+            id += ";no-type-cache";
+        }
+        return id;
+    }
+
+    static void report(const type_cache_stats &stats) {
+        auto total = stats.hits + stats.misses;
+        auto rate  = total ? 100.0 * double(stats.hits) / double(total) : 0.0;
+        llvm::errs() << llvm::formatv(
+            "type cache: {0} hits, {1} misses ({2:F1}% hit rate)\n", stats.hits, stats.misses, rate
         );
+    }
+
+    static void report(const unsupported_stats &stats) {
+        std::vector< std::pair< llvm::StringRef, std::size_t > > counts;
+        for (const auto &entry : stats.counts) {
+            counts.emplace_back(entry.getKey(), entry.getValue());
+        }
+
+        llvm::sort(counts);
+        for (auto [kind, count] : counts) {
+            llvm::errs() << llvm::formatv("unsupported {0}: {1}\n", kind, count);
+        }
+    }
+
+    LogicalResult print_module(const OwningModuleRef &mod, llvm::raw_ostream &os) {
+        if (emit_bytecode_flag) {
+            return bytecode::write_bytecode(mod.get(), os);
+        }
 
-        auto actx = &ast->getASTContext();
+        mod->print(os);
+        return mlir::success();
+    }
+
+    llvm::StringRef module_file_extension() { return emit_bytecode_flag ? ".vbc" : ".mlir"; }
+
+    OwningModuleRef emit_module(clang::ASTUnit *unit, mlir::MLIRContext *mctx) {
+        auto actx = &unit->getASTContext();
+
+        auto opts = generator_options();
+        // units loaded from ast files deserialize declarations lazily, that
+        // is not safe to do from multiple threads
+        opts.parallel_bodies &= !unit->isMainFileAST();
+
+        type_cache_stats stats;
+        if (type_cache_stats_flag) {
+            opts.type_stats = &stats;
+        }
+
+        unsupported_stats unsupported;
+        opts.unsupported = &unsupported;
+
+        using enum codegen_meta;
+        auto mod = id_meta_flag ? CodeGenDriver< identifiers >(actx, mctx, opts).emit_module(unit)
+                 : compact_locations_flag ? CodeGenDriver< compact_locations >(actx, mctx, opts).emit_module(unit)
+                 : CodeGenDriver< locations >(actx, mctx, opts).emit_module(unit);
+
+        if (type_cache_stats_flag) {
+            report(stats);
+        }
+
+        report(unsupported);
+        return mod;
+    }
+
+    template< typename CodeGen >
+    static OwningModuleRef stream_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, mlir::MLIRContext *mctx, codegen_options opts
+    ) {
+        type_cache_stats stats;
+        if (type_cache_stats_flag) {
+            opts.type_stats = &stats;
+        }
 
+        unsupported_stats unsupported;
+        opts.unsupported = &unsupported;
+
+        OwningModuleRef mod;
+        auto action = std::make_unique< CodeGenAction< CodeGen > >(*mctx, mod, std::move(opts));
+        if (!clang::tooling::runToolOnCodeWithArgs(std::move(action), code, args, filename, "vast-cc")) {
+            return nullptr;
+        }
+
+        if (type_cache_stats_flag) {
+            report(stats);
+        }
+
+        report(unsupported);
+        return mod;
+    }
+
+    static OwningModuleRef stream_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, mlir::MLIRContext *mctx,
+        codegen_options opts = generator_options()
+    ) {
+        using enum codegen_meta;
         if (id_meta_flag) {
-            return CodeGenWithMetaIDs(actx, mctx).emit_module(ast.get());
+            return stream_module< CodeGenDriver< identifiers > >(code, args, filename, mctx, std::move(opts));
+        } else if (compact_locations_flag) {
+            return stream_module< CodeGenDriver< compact_locations > >(code, args, filename, mctx, std::move(opts));
         } else {
-            return DefaultCodeGen(actx, mctx).emit_module(ast.get());
+            return stream_module< CodeGenDriver< locations > >(code, args, filename, mctx, std::move(opts));
+        }
+    }
+
+    OwningModuleRef emit_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, mlir::MLIRContext *mctx
+    ) {
+        auto cache = module_cache::get();
+        if (!cache) {
+            return stream_module(code, args, filename, mctx);
+        }
+
+        auto key = cache->key(code, args, filename, generator_options_id());
+        if (!key) {
+            // preprocessing failed, let the codegen report errors
+            return stream_module(code, args, filename, mctx);
+        }
+
+        if (auto mod = cache->load(*key, mctx)) {
+            return mod;
         }
+
+        auto mod = stream_module(code, args, filename, mctx);
+        if (mod) {
+            cache->store(*key, mod);
+        }
+
+        return mod;
+    }
+
+    LogicalResult emit_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, mlir::MLIRContext *mctx, llvm::raw_ostream &os
+    ) {
+        if (!stream_definitions_flag) {
+            auto mod = emit_module(code, args, filename, mctx);
+            if (!mod) {
+                return mlir::failure();
+            }
+
+            return print_module(mod, os);
+        }
+
+        if (emit_bytecode_flag) {
+            llvm::errs() << "error: streamed definitions are written in the textual form only\n";
+            return mlir::failure();
+        }
+
+        // streamed modules are never complete in memory, hence not cached
+        module_stream stream;
+        if (mlir::failed(stream.open())) {
+            llvm::errs() << "error: cannot create temporary file for streamed definitions\n";
+            return mlir::failure();
+        }
+
+        auto opts = generator_options();
+        opts.stream_definition = [&] (Operation *op) { stream.write(op); };
+
+        auto mod = stream_module(code, args, filename, mctx, std::move(opts));
+        if (!mod) {
+            return mlir::failure();
+        }
+
+        return stream.finish(mod, os);
+    }
+
+    static OwningModuleRef from_source_parser(
+        const llvm::MemoryBuffer *input, mlir::MLIRContext *mctx
+    ) {
+        auto mod = emit_module(input->getBuffer(), compiler_options(), "input.cc", mctx);
+
+        if (auto cache = module_cache::get()) {
+            cache->finish();
+        }
+
+        return mod;
+    }
+
+    static LogicalResult from_source_translation(
+        const llvm::MemoryBuffer *input, llvm::raw_ostream &os, mlir::MLIRContext *mctx
+    ) {
+        if (stream_definitions_flag) {
+            return emit_module(input->getBuffer(), compiler_options(), "input.cc", mctx, os);
+        }
+
+        // the same as the default translation to mlir
+        auto mod = from_source_parser(input, mctx);
+        if (!mod || mlir::failed(mlir::verify(*mod))) {
+            return mlir::failure();
+        }
+
+        return print_module(mod, os);
     }
 
     mlir::LogicalResult registerFromSourceParser() {
-        mlir::TranslateToMLIRRegistration from_source(
+        // registered as a generic translation, so that streamed definitions
+        // are written directly to the output
+        mlir::TranslateRegistration from_source(
             "from-source",
-            [](llvm::SourceMgr &mgr, mlir::MLIRContext *ctx) -> OwningModuleRef {
+            [](llvm::SourceMgr &mgr, llvm::raw_ostream &os, mlir::MLIRContext *ctx) {
                 VAST_CHECK(mgr.getNumBuffers() == 1,    "expected single input buffer");
                 auto buffer = mgr.getMemoryBuffer(mgr.getMainFileID());
-                return from_source_parser(buffer, ctx);
+                return from_source_translation(buffer, os, ctx);
             });
 
         return mlir::success();
@@ -0,0 +1,48 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/ASTUnit.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/MLIRContext.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <string>
+#include <vector>
+
+namespace vast::hl
+{
+    // Compiler options passed to vast-cc by `--ccopts`.
+    std::vector< std::string > compiler_options();
+
+    // Prints the module in the form selected by vast-cc options, that is the
+    // vast bytecode with `--emit-bytecode`.
+    LogicalResult print_module(const OwningModuleRef &mod, llvm::raw_ostream &os);
+
+    // Extension of files of printed modules.
+    llvm::StringRef module_file_extension();
+
+    // Emits module for the given unit with the generator selected
+    // by vast-cc options (e.g., `--id-meta`).
+    OwningModuleRef emit_module(clang::ASTUnit *unit, MContext *mctx);
+
+    // Parses `code` and emits its declarations as they are parsed, without
+    // building an ASTUnit first. Returns null module if clang fails.
+    OwningModuleRef emit_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, MContext *mctx
+    );
+
+    // Emits module of `code` and prints it to `os`. With `--stream-definitions`,
+    // function definitions are written as soon as they are emitted.
+    LogicalResult emit_module(
+        llvm::StringRef code, const std::vector< std::string > &args,
+        llvm::StringRef filename, MContext *mctx, llvm::raw_ostream &os
+    );
+
+} // namespace vast::hl
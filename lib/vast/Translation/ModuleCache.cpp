@@ -0,0 +1,216 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/CachePruning.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/MemoryBuffer.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Bytecode/Bytecode.hpp"
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Version.hpp"
+
+#include "ModuleCache.hpp"
+
+#include <chrono>
+
+namespace vast::hl
+{
+    static llvm::cl::opt< std::string > cache_dir(
+        "cache-dir",
+        llvm::cl::desc("Directory of the cache of emitted modules"),
+        llvm::cl::value_desc("directory")
+    );
+
+    static llvm::cl::opt< uint64_t > cache_size(
+        "cache-size",
+        llvm::cl::desc("Size limit of the module cache in megabytes"),
+        llvm::cl::init(1024)
+    );
+
+    static llvm::cl::opt< bool > cache_stats(
+        "cache-stats",
+        llvm::cl::desc("Report hits and misses of the module cache")
+    );
+
+    // the cache is pruned with llvm cache pruning, that considers only files
+    // with this prefix
+    static constexpr llvm::StringLiteral cache_file_prefix = "llvmcache-vast-";
+
+    static void hash_part(llvm::SHA256 &hasher, string_ref part) {
+        hasher.update(part);
+        // separate parts, so that concatenations of different parts do not collide
+        hasher.update(string_ref("\0", 1));
+    }
+
+    //
+    // Hashes tokens of the preprocessed source with their locations,
+    // that end up in the emitted module.
+    //
+    struct hash_tokens_action : clang::PreprocessorFrontendAction {
+        explicit hash_tokens_action(llvm::SHA256 &hasher) : hasher(hasher) {}
+
+    protected:
+        void ExecuteAction() override {
+            auto &pp = getCompilerInstance().getPreprocessor();
+            auto &sm = pp.getSourceManager();
+
+            pp.EnterMainSourceFile();
+
+            clang::Token tok;
+            for (pp.Lex(tok); tok.isNot(clang::tok::eof); pp.Lex(tok)) {
+                hash_part(hasher, pp.getSpelling(tok));
+
+                if (auto loc = sm.getPresumedLoc(tok.getLocation()); loc.isValid()) {
+                    hash_part(hasher, loc.getFilename());
+                    hash_part(hasher, std::to_string(loc.getLine()));
+                    hash_part(hasher, std::to_string(loc.getColumn()));
+                }
+            }
+        }
+
+    private:
+        llvm::SHA256 &hasher;
+    };
+
+    // Version of vast and identity of this build, so that modules emitted by
+    // other builds are never reused.
+    static std::string build_id() {
+        auto exe = llvm::sys::fs::getMainExecutable(nullptr, reinterpret_cast< void * >(&build_id));
+
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(exe, status)) {
+            return PROJECT_VER;
+        }
+
+        auto mtime = status.getLastModificationTime().time_since_epoch().count();
+        return llvm::formatv("{0}-{1}-{2}", PROJECT_VER, status.getSize(), mtime).str();
+    }
+
+    module_cache *module_cache::get() {
+        if (cache_dir.empty()) {
+            return nullptr;
+        }
+
+        static module_cache cache;
+        return &cache;
+    }
+
+    std::optional< std::string > module_cache::key(
+        string_ref code, const std::vector< std::string > &args,
+        string_ref filename, string_ref options
+    ) const {
+        llvm::SHA256 hasher;
+
+        static const auto build = build_id();
+        hash_part(hasher, build);
+
+        for (const auto &arg : args) {
+            hash_part(hasher, arg);
+        }
+
+        hash_part(hasher, options);
+
+        auto action = std::make_unique< hash_tokens_action >(hasher);
+        if (!clang::tooling::runToolOnCodeWithArgs(std::move(action), code, args, filename, "vast-cc")) {
+            return std::nullopt;
+        }
+
+        return llvm::toHex(hasher.final(), /* LowerCase */ true);
+    }
+
+    std::string module_cache::path(string_ref key) const {
+        llvm::SmallString< 256 > path(cache_dir.getValue());
+        // modules are cached in the bytecode, that loads faster than text
+        llvm::sys::path::append(path, cache_file_prefix + key + ".vbc");
+        return path.str().str();
+    }
+
+    OwningModuleRef module_cache::load(string_ref key, MContext *mctx) {
+        auto file = path(key);
+
+        int fd;
+        if (llvm::sys::fs::openFileForRead(file, fd)) {
+            ++misses;
+            return nullptr;
+        }
+
+        // mark the module as recently used, access times are not reliable
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+        llvm::sys::fs::closeFile(fd);
+
+        auto buffer = llvm::MemoryBuffer::getFile(file, /* IsText */ false, /* RequiresNullTerminator */ false);
+        if (!buffer) {
+            ++misses;
+            return nullptr;
+        }
+
+        loadCodeGenDialects(*mctx);
+        auto mod = bytecode::read_bytecode((*buffer)->getBuffer(), mctx);
+        if (!mod) {
+            // corrupted or incompatible entry, it gets overwritten
+            ++misses;
+            return nullptr;
+        }
+
+        ++hits;
+        return mod;
+    }
+
+    void module_cache::store(string_ref key, const OwningModuleRef &mod) {
+        if (llvm::sys::fs::create_directories(cache_dir)) {
+            return;
+        }
+
+        // write to a temporary file first, so that concurrent runs never read
+        // a partially written module
+        llvm::SmallString< 256 > model(cache_dir.getValue());
+        llvm::sys::path::append(model, "tmp-" + key + "-%%%%%%");
+
+        int fd;
+        llvm::SmallString< 256 > tmp;
+        if (llvm::sys::fs::createUniqueFile(model, fd, tmp)) {
+            return;
+        }
+
+        bool written = false;
+        {
+            // the bytecode keeps locations, the cached module replaces the emitted one
+            llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+            written = mlir::succeeded(bytecode::write_bytecode(mod.get(), os));
+            os.flush();
+            written = written && !os.has_error();
+            os.clear_error();
+        }
+
+        if (!written || llvm::sys::fs::rename(tmp, path(key))) {
+            llvm::sys::fs::remove(tmp);
+        }
+    }
+
+    void module_cache::finish() {
+        llvm::CachePruningPolicy policy;
+        policy.Interval   = std::chrono::seconds(0);
+        policy.Expiration = std::chrono::seconds(0);
+        policy.MaxSizePercentageOfAvailableSpace = 0;
+        policy.MaxSizeBytes = cache_size * 1024 * 1024;
+
+        llvm::pruneCache(cache_dir, policy);
+
+        if (cache_stats) {
+            llvm::errs() << llvm::formatv("cache: {0} hits, {1} misses\n", hits.load(), misses.load());
+        }
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,54 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/MLIRContext.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // ModuleCache
+    //
+    // Content-addressed on-disk cache of emitted modules, enabled by
+    // `--cache-dir`. The key hashes the preprocessed source (tokens and their
+    // locations), the compiler arguments, generator options and the build of
+    // vast. Modules are stored in the vast bytecode. The cache is bounded by
+    // `--cache-size`, least recently used modules are evicted first.
+    //
+    struct module_cache {
+        // Returns null if the cache is not enabled.
+        static module_cache *get();
+
+        // `options` identify generator options that affect the emitted module.
+        std::optional< std::string > key(
+            string_ref code, const std::vector< std::string > &args,
+            string_ref filename, string_ref options
+        ) const;
+
+        OwningModuleRef load(string_ref key, MContext *mctx);
+
+        void store(string_ref key, const OwningModuleRef &mod);
+
+        // Evicts the least recently used modules over the size limit and
+        // reports statistics if requested by `--cache-stats`.
+        void finish();
+
+        std::atomic_uint64_t hits   = 0;
+        std::atomic_uint64_t misses = 0;
+
+    private:
+        std::string path(string_ref key) const;
+    };
+
+} // namespace vast::hl
@@ -0,0 +1,106 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/FileSystem.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/IR/Verifier.h>
+VAST_UNRELAX_WARNINGS
+
+#include "ModuleStream.hpp"
+
+#include <array>
+
+namespace vast::hl
+{
+    module_stream::~module_stream() {
+        spool.reset();
+        if (!path.empty()) {
+            llvm::sys::fs::remove(path);
+        }
+    }
+
+    LogicalResult module_stream::open() {
+        int fd;
+        if (llvm::sys::fs::createTemporaryFile("vast-stream", "mlir", fd, path)) {
+            return mlir::failure();
+        }
+
+        spool = std::make_unique< llvm::raw_fd_ostream >(fd, /* shouldClose */ true);
+        return mlir::success();
+    }
+
+    static mlir::OpPrintingFlags printing_flags() {
+        // ops are printed out of the module, names of values are local anyway
+        return mlir::OpPrintingFlags().useLocalScope();
+    }
+
+    void module_stream::write(Operation *op) {
+        // released bodies are never seen again, hence they are verified here
+        if (mlir::failed(mlir::verify(op))) {
+            failed = true;
+            return;
+        }
+
+        op->print(*spool, printing_flags());
+        *spool << "\n";
+    }
+
+    LogicalResult module_stream::finish(const OwningModuleRef &mod, llvm::raw_ostream &os) {
+        spool->close();
+        if (failed || spool->has_error()) {
+            spool->clear_error();
+            return mlir::failure();
+        }
+
+        // symbols of streamed definitions are not in the module anymore, hence
+        // top-level operations are verified one by one, without symbol uses
+        for (auto &op : mod->getBody()->getOperations()) {
+            if (mlir::failed(mlir::verify(&op))) {
+                return mlir::failure();
+            }
+        }
+
+        os << "module";
+        if (auto attrs = mod->getOperation()->getAttrDictionary(); !attrs.empty()) {
+            os << " attributes ";
+            attrs.print(os);
+        }
+        os << " {\n";
+
+        for (auto &op : mod->getBody()->getOperations()) {
+            op.print(os, printing_flags());
+            os << "\n";
+        }
+
+        auto file = llvm::sys::fs::openNativeFileForRead(path);
+        if (!file) {
+            llvm::consumeError(file.takeError());
+            return mlir::failure();
+        }
+
+        std::array< char, 1 << 16 > buffer;
+        while (true) {
+            auto read = llvm::sys::fs::readNativeFile(*file, buffer);
+            if (!read) {
+                llvm::consumeError(read.takeError());
+                llvm::sys::fs::closeFile(*file);
+                return mlir::failure();
+            }
+
+            if (*read == 0) {
+                break;
+            }
+
+            os.write(buffer.data(), *read);
+        }
+
+        llvm::sys::fs::closeFile(*file);
+
+        os << "}\n";
+        return mlir::success();
+    }
+
+} // namespace vast::hl
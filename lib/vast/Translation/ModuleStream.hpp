@@ -0,0 +1,48 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/Support/LogicalResult.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+
+namespace vast::hl
+{
+    //
+    // ModuleStream
+    //
+    // Writes function definitions as soon as they are emitted, so that the
+    // codegen can release their bodies (see `codegen_options::stream_definition`).
+    // Definitions are spooled to a temporary file, because attributes of the
+    // module (e.g., data layout) are known only once the whole unit is emitted.
+    // `finish` then writes the module followed by the spooled definitions.
+    //
+    struct module_stream {
+        module_stream() = default;
+        ~module_stream();
+
+        module_stream(const module_stream &) = delete;
+        module_stream &operator=(const module_stream &) = delete;
+
+        LogicalResult open();
+
+        void write(Operation *op);
+
+        LogicalResult finish(const OwningModuleRef &mod, llvm::raw_ostream &os);
+
+    private:
+        llvm::SmallString< 128 > path;
+        std::unique_ptr< llvm::raw_fd_ostream > spool;
+        bool failed = false;
+    };
+
+} // namespace vast::hl
@@ -0,0 +1,11 @@
+# Copyright (c) 2022-present, Trail of Bits, Inc.
+
+# Generates functions with left-leaning chains of the given number of operands.
+
+import sys
+
+terms = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+print("int sum(int a) { return " + " + ".join(["a"] * terms) + "; }")
+print("int cmp(int a) { return " + " == ".join(["a"] * terms) + "; }")
+print("int comma(int a) { return (" + ", ".join(["a"] * terms) + "); }")
@@ -0,0 +1,13 @@
+typedef unsigned long size;
+
+struct buffer { char *data; size length; };
+
+struct unused { int value; };
+
+enum mode { mode_read, mode_write };
+
+int header_counter;
+
+static inline size twice(size v) { return v + v; }
+
+int unused_function(int v) { return v; }
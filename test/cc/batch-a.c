@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{ "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-c", "%s"] }]' > %t/compile_commands.json
+// RUN: vast-cc --compile-commands=%t/compile_commands.json --output-dir=%t/out --jobs=2 2>&1 | FileCheck %s --check-prefix=REPORT
+// RUN: FileCheck %s < %t/out%s.mlir
+
+// REPORT: [ok] {{.*}} ms {{.*}}batch-a.c
+// REPORT: lifted 1 of 1 translation units
+
+// CHECK: hl.func external @batch
+int batch(int a) { return a; }
@@ -0,0 +1,19 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{ "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-c", "%s"] },' > %t/compile_commands.json
+// RUN: echo ' { "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-c", "%s"] },' >> %t/compile_commands.json
+// RUN: echo ' { "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-DVARIANT", "-c", "%s"] }]' >> %t/compile_commands.json
+// RUN: vast-cc --compile-commands=%t/compile_commands.json --output-dir=%t/out --jobs=2 2>&1 | FileCheck %s --check-prefix=REPORT
+// RUN: FileCheck %s < %t/out%s.mlir
+// RUN: cat %t/out%s.*.mlir | FileCheck %s --check-prefix=VARIANT
+
+// REPORT: warning: skipping duplicate compile command of {{.*}}batch-b.c
+// REPORT: warning: multiple compile commands of {{.*}}batch-b.c, emitting to {{.*}}batch-b.c.{{[0-9A-F]+}}.mlir
+// REPORT: lifted 2 of 2 translation units
+
+// CHECK: hl.func external @batch
+// VARIANT: hl.func external @variant
+#ifdef VARIANT
+int variant(int a) { return a; }
+#else
+int batch(int a) { return a; }
+#endif
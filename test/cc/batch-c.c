@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{ "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-DBROKEN", "-c", "%s"] },' > %t/compile_commands.json
+// RUN: echo ' { "directory": "%S", "file": "%s", "arguments": ["clang", "-xc", "-c", "%s"] }]' >> %t/compile_commands.json
+// RUN: vast-cc --compile-commands=%t/compile_commands.json --output-dir=%t/out --jobs=2 > %t/report 2>&1 || true
+// RUN: FileCheck %s --check-prefix=REPORT < %t/report
+
+// a unit that clang rejects fails on its own, the rest of the batch is lifted
+// REPORT-DAG: [failed] {{.*}} ms {{.*}}batch-c.c: clang reported errors
+// REPORT-DAG: [ok] {{.*}} ms {{.*}}batch-c.c
+// REPORT: lifted 1 of 2 translation units
+
+#ifdef BROKEN
+int broken(void) { return undeclared + (struct missing){ 0 }.value; }
+#endif
+
+int valid(int a) { return a; }
@@ -0,0 +1,41 @@
+// RUN: vast-cc --ccopts -xc --from-source %s > %t.mlir
+// RUN: vast-cc --ccopts -xc --from-source --emit-bytecode %s > %t.vbc
+// RUN: vast-opt --mlir-print-debuginfo %t.mlir > %t.text.mlir
+// RUN: vast-opt --mlir-print-debuginfo %t.vbc > %t.bytecode.mlir
+// RUN: diff %t.text.mlir %t.bytecode.mlir
+// RUN: vast-opt --emit-bytecode %t.mlir | vast-opt --mlir-print-debuginfo | diff %t.text.mlir -
+// RUN: vast-query --show-symbols=functions %t.vbc | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source --compact-locations --emit-bytecode %s > %t.compact.vbc
+// RUN: vast-query --show-symbols=vars %t.compact.vbc | FileCheck %s --check-prefix=VARS
+
+// CHECK-DAG: hl.func : sum
+// CHECK-DAG: hl.func : find
+
+// VARS-DAG: hl.var : total : {{.*}}:24:5{{$}}
+// VARS-DAG: hl.var : message : {{.*}}:41:1{{$}}
+
+struct point { int x; const volatile unsigned long y; };
+
+typedef struct point point_t;
+
+enum color { red, green = 4 };
+
+int sum(point_t *restrict pts, unsigned n) {
+    unsigned long long total = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        total += pts[i].x + pts[i].y;
+    }
+    return (int)total;
+}
+
+int find(const int values[16], int value) {
+    int i = 0;
+again:
+    if (values[i] == value)
+        return i;
+    if (++i < 16)
+        goto again;
+    return -(int)green;
+}
+
+static const char message[] = "bytecode \"round\" trip";
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: vast-cc --from-source %s --cache-dir=%t/cache --cache-stats > %t/miss.mlir 2> %t/miss.log
+// RUN: vast-cc --from-source %s --cache-dir=%t/cache --cache-stats > %t/hit.mlir 2> %t/hit.log
+// RUN: diff %t/miss.mlir %t/hit.mlir
+// RUN: FileCheck %s --check-prefix=MISS < %t/miss.log
+// RUN: FileCheck %s --check-prefix=HIT < %t/hit.log
+// RUN: vast-cc --from-source %s --id-meta --cache-dir=%t/cache --cache-stats 2>&1 > /dev/null | FileCheck %s --check-prefix=MISS
+// RUN: vast-cc --from-source %s --ccopts -DVALUE=2 --cache-dir=%t/cache --cache-stats 2>&1 > /dev/null | FileCheck %s --check-prefix=MISS
+
+// MISS: cache: 0 hits, 1 misses
+// HIT: cache: 1 hits, 0 misses
+
+#ifndef VALUE
+#define VALUE 1
+#endif
+
+int cached(void) { return VALUE; }
@@ -0,0 +1,16 @@
+// RUN: python3 %S/Inputs/deep-expressions.py 10000 > %t.c
+// RUN: vast-cc --ccopts -xc --ccopts -w --from-source %t.c | FileCheck %s
+
+// Chains of expressions are emitted without recursion on their left operands.
+
+// CHECK-LABEL: hl.func external @sum
+// CHECK-COUNT-9999: hl.add
+// CHECK: hl.return
+
+// CHECK-LABEL: hl.func external @cmp
+// CHECK-COUNT-9999: hl.cmp
+// CHECK: hl.return
+
+// CHECK-LABEL: hl.func external @comma
+// CHECK-COUNT-9999: hl.bin.comma
+// CHECK: hl.return
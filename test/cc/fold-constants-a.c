@@ -0,0 +1,32 @@
+// RUN: vast-cc --ccopts -xc --from-source --fold-constants %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source --fold-constants %s > %t && vast-opt %t | diff -B %t -
+// RUN: vast-cc --ccopts -xc --from-source %s | FileCheck %s --check-prefix=NOFOLD
+
+struct foo { int a; int b; };
+
+enum { shift = 3 };
+
+// CHECK: hl.func {{.*}}@size
+// NOFOLD: hl.func {{.*}}@size
+unsigned long size(void) {
+    // CHECK-NOT: hl.sizeof.type
+    // CHECK: hl.const #hl.integer<32>{{.*}}hl.folded = "BinaryOperator"
+    // CHECK-NEXT: hl.return
+    // NOFOLD: hl.sizeof.type
+    // NOFOLD: hl.mul
+    // NOFOLD-NOT: hl.folded
+    return sizeof(struct foo) * 4;
+}
+
+// CHECK: hl.func {{.*}}@mask
+int mask(int x) {
+    switch (x) {
+        // CHECK: hl.case
+        // CHECK: hl.const #hl.integer<8>{{.*}}hl.folded = "BinaryOperator"
+        case 1 << shift: return 1;
+    }
+
+    // CHECK: hl.const #hl.integer<7>{{.*}}hl.folded = "BinaryOperator"
+    // CHECK: hl.bin.and
+    return x & ((1 << shift) - 1);
+}
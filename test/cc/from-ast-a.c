@@ -0,0 +1,12 @@
+// RUN: clang -xc -emit-ast %s -o %t.ast
+// RUN: vast-cc --from-ast %t.ast | FileCheck %s
+// RUN: vast-cc --from-ast %t.ast > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.typedef "size" : !hl.int
+typedef int size;
+
+// CHECK: hl.func external @twice
+size twice(size v) {
+    // CHECK: hl.add
+    return v + v;
+}
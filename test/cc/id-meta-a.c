@@ -0,0 +1,25 @@
+// RUN: vast-cc --ccopts -xc --from-source --id-meta --mlir-print-debuginfo %s > %t
+// RUN: vast-cc --ccopts -xc --from-source --id-meta --mlir-print-debuginfo --parallel-bodies %s | diff %t -
+// RUN: vast-cc --ccopts -xc --ccopts -DEXTRA --from-source --id-meta --mlir-print-debuginfo %s > %t.extra
+// RUN: grep -o 'meta.id<[0-9]*>' %t | sort -u > %t.ids
+// RUN: grep -o 'meta.id<[0-9]*>' %t.extra | sort -u > %t.extra.ids
+// RUN: comm -23 %t.ids %t.extra.ids > %t.missing && test ! -s %t.missing
+// RUN: FileCheck %s < %t
+
+// Identifiers of unchanged declarations do not depend on preceding code.
+
+// CHECK: hl.func external @square
+// CHECK: loc(fused<#meta.id<{{[0-9]+}}>>[unknown])
+
+#ifdef EXTRA
+int extra(int v) { return v + 1; }
+#endif
+
+int square(int v) { return v * v; }
+
+int sum(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i)
+        total += square(i);
+    return total;
+}
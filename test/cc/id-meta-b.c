@@ -0,0 +1,21 @@
+// RUN: vast-cc --ccopts -xc --from-source --id-meta --tolerate-unsupported --mlir-print-debuginfo %s > %t
+// RUN: vast-cc --ccopts -xc --ccopts -DEXTRA --from-source --id-meta --tolerate-unsupported --mlir-print-debuginfo %s > %t.extra
+// RUN: grep -o 'meta.id<[0-9]*>' %t | sort -u > %t.ids
+// RUN: grep -o 'meta.id<[0-9]*>' %t.extra | sort -u > %t.extra.ids
+// RUN: comm -23 %t.ids %t.extra.ids > %t.missing && test ! -s %t.missing
+// RUN: FileCheck %s < %t
+
+// Declarations without USRs are identified by their parent and their ordinal
+// among declarations of the same kind, not by their offset in the file.
+
+// CHECK: hl.unsupported.decl "StaticAssertDecl"
+// CHECK: hl.unsupported.decl "StaticAssertDecl"
+
+#ifdef EXTRA
+int extra(int v) { return v + 1; }
+#endif
+
+_Static_assert(sizeof(int) == 4, "int");
+_Static_assert(sizeof(char) == 1, "char");
+
+int square(int v) { return v * v; }
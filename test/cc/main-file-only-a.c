@@ -0,0 +1,33 @@
+// RUN: vast-cc --ccopts -xc --ccopts -I%S/Inputs --from-source --main-file-only %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --ccopts -I%S/Inputs --from-source --emit-filter='main-file-only\.h$' %s | FileCheck %s --check-prefix=FILTER
+// RUN: vast-cc --ccopts -xc --ccopts -I%S/Inputs --from-source --emit-filter='main-file-only(' %s > %t.invalid 2>&1 || true
+// RUN: FileCheck %s --check-prefix=INVALID < %t.invalid
+
+// INVALID: invalid regex 'main-file-only(':
+
+#include "main-file-only.h"
+
+// CHECK-NOT: hl.struct "unused"
+// CHECK-NOT: @unused_function
+// CHECK-DAG: hl.typedef "size"
+// CHECK-DAG: hl.struct "buffer"
+// CHECK-DAG: hl.func {{.*}}@twice
+// CHECK-DAG: hl.var "header_counter"
+// CHECK-NOT: hl.return
+
+// FILTER: hl.struct "unused"
+// FILTER: hl.func external @unused_function
+
+// CHECK: hl.func external @length
+size length(struct buffer *buf, enum mode m) {
+    // CHECK: hl.return
+    return m == mode_read ? twice(buf->length) : header_counter;
+}
+
+// the header global is declared once, at file scope, and stays visible in other bodies
+// CHECK-NOT: hl.var "header_counter"
+// CHECK: hl.func external @counter
+int counter(void) {
+    // CHECK: hl.globref "header_counter"
+    return header_counter;
+}
@@ -0,0 +1,39 @@
+// RUN: vast-cc --from-source %s > %t
+// RUN: vast-cc --from-source --parallel-bodies %s | diff %t -
+// RUN: vast-cc --from-source --parallel-bodies %s | FileCheck %s
+
+struct point { int x, y; };
+
+int global = 7;
+
+int square(int v) { return v * v; }
+
+// CHECK: hl.func external @norm
+int norm(struct point p) {
+    // CHECK: hl.call @square
+    return square(p.x) + square(p.y) + global;
+}
+
+// local type declarations are emitted in the serial phase
+// CHECK: hl.func external @local_type
+int local_type(void) {
+    struct pair { int a, b; } v = { 1, 2 };
+    return v.a + v.b;
+}
+
+// CHECK: hl.func external @labels
+int labels(int n) {
+    int sum = 0;
+loop:
+    if (n > 0) {
+        sum += n--;
+        goto loop;
+    }
+    return sum;
+}
+
+// CHECK: hl.func external @main
+int main(void) {
+    struct point p = { 3, 4 };
+    return norm(p) + local_type() + labels(3);
+}
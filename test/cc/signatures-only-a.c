@@ -0,0 +1,26 @@
+// RUN: vast-cc --ccopts -xc --from-source --signatures-only %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source --signatures-only %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.typedef "size"
+typedef unsigned long size;
+
+// CHECK: hl.struct "buffer"
+struct buffer { char *data; size length; };
+
+// CHECK: hl.enum "mode"
+// CHECK: hl.enum.const "mode_write" = #hl.integer<2>
+// CHECK-NOT: hl.const
+enum mode { mode_read = 1 << 0, mode_write = 1 << 1 };
+
+// CHECK: hl.var "counter" : !hl.lvalue<!hl.int>
+// CHECK-NOT: hl.const
+int counter = 42;
+
+// CHECK: hl.func {{.*}}@length
+// CHECK-NOT: hl.return
+size length(struct buffer *buf, enum mode m) {
+    return m == mode_read ? buf->length : counter;
+}
+
+// CHECK-NOT: hl.call
+int main(void) { return length(0, mode_read); }
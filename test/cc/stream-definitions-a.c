@@ -0,0 +1,26 @@
+// RUN: vast-cc --ccopts -xc --from-source --stream-definitions %s > %t
+// RUN: vast-opt %t | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | FileCheck %s
+
+// CHECK-DAG: hl.typedef "counter"
+typedef int counter;
+
+// CHECK-DAG: hl.var "total"
+counter total = 0;
+
+int add(int v);
+
+// CHECK-DAG: hl.func external @add
+int add(int v) {
+    total += v;
+    return total;
+}
+
+// redeclarations of streamed definitions are not emitted again
+int add(int v);
+
+// CHECK-DAG: hl.func external @main
+int main(void) {
+    // CHECK-DAG: hl.call @add
+    return add(1) + add(2);
+}
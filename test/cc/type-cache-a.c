@@ -0,0 +1,27 @@
+// RUN: vast-cc --ccopts -xc --from-source %s > %t
+// RUN: vast-cc --ccopts -xc --from-source --no-type-cache %s | diff %t -
+// RUN: vast-cc --ccopts -xc --from-source --type-cache-stats %s 2> %t.stats | diff %t -
+// RUN: FileCheck %s --check-prefix=STATS < %t.stats
+// RUN: FileCheck %s < %t
+
+// STATS: type cache: {{[1-9][0-9]*}} hits, {{[0-9]+}} misses
+
+typedef const int cint;
+
+struct node;
+
+// CHECK: hl.var "head" : !hl.lvalue<!hl.ptr<{{.*}}"node"{{.*}}>>
+struct node *head;
+
+struct node { cint value; struct node *next; };
+
+// CHECK: hl.func external @sum
+int sum(struct node *n) {
+    int total = 0;
+    // CHECK: hl.var "v" : !hl.lvalue<{{.*}}"cint"{{.*}}>
+    for (; n; n = n->next) {
+        cint v = n->value;
+        total += v;
+    }
+    return total;
+}
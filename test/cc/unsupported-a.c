@@ -0,0 +1,37 @@
+// RUN: vast-cc --ccopts -xc --from-source --tolerate-unsupported %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source --tolerate-unsupported %s > %t && vast-opt %t | diff -B %t -
+// RUN: vast-cc --ccopts -xc --from-source --tolerate-unsupported %s 2>&1 >/dev/null | FileCheck %s --check-prefix=STATS
+// RUN: vast-cc --ccopts -xc --from-source --tolerate-unsupported --mlir-print-local-scope %s | FileCheck %s --check-prefix=RANGE
+// RUN: vast-cc --ccopts -xc --from-source --tolerate-unsupported --id-meta --mlir-print-local-scope %s | FileCheck %s --check-prefix=RANGE
+
+// STATS: unsupported Atomic: {{[0-9]+}}
+// STATS: unsupported AtomicExpr: 1
+// STATS: unsupported GCCAsmStmt: 2
+// STATS: unsupported StaticAssertDecl: 1
+
+// placeholders keep full source ranges of their nodes, whatever the meta generator
+// RANGE: hl.unsupported.decl "StaticAssertDecl" {range = loc(fused["{{.*}}unsupported-a.c":19:1, "{{.*}}unsupported-a.c":19:39])}
+// RANGE: hl.var "counter" : !hl.lvalue<!hl.unsupported<"Atomic">>
+// RANGE: hl.unsupported "GCCAsmStmt" {range = loc(fused["{{.*}}unsupported-a.c":28:5, "{{.*}}unsupported-a.c":28:37])}
+// RANGE: hl.unsupported "AtomicExpr" {range = loc(fused["{{.*}}unsupported-a.c":36:12, "{{.*}}unsupported-a.c":36:47])} : !hl.int
+
+// CHECK: hl.unsupported.decl "StaticAssertDecl"
+_Static_assert(sizeof(int) == 4, "int");
+
+// CHECK: hl.var "counter" : !hl.lvalue<!hl.unsupported<"Atomic">>
+_Atomic int counter;
+
+// CHECK: hl.func {{.*}}@barrier
+void barrier(void) {
+    // CHECK: hl.unsupported "GCCAsmStmt"
+    // CHECK: hl.unsupported "GCCAsmStmt"
+    __asm__ volatile("" ::: "memory");
+    __asm__ volatile("nop");
+}
+
+// CHECK: hl.func {{.*}}@load
+int load(int *p) {
+    // CHECK: [[V:%[0-9]+]] = hl.unsupported "AtomicExpr" {{.*}}: !hl.int
+    // CHECK: hl.return [[V]]
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,15 @@
+// RUN: vast-cc --ccopts -xc --from-source --compact-locations --mlir-print-debuginfo %s > %t
+// RUN: FileCheck %s --check-prefix=MLIR < %t
+// RUN: vast-query --show-symbols=vars %t | FileCheck %s
+
+// MLIR-NOT: meta.
+// MLIR: loc("{{.*}}compact-locations.c":0:{{[0-9]+}})
+
+// CHECK-DAG: hl.var : a : {{.*}}compact-locations.c:12:5{{$}}
+// CHECK-DAG: hl.var : b : {{.*}}compact-locations.c:13:5{{$}}
+int main()
+{
+    int a = 1;
+    int b = a + 1;
+    return b;
+}
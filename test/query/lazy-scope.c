@@ -0,0 +1,43 @@
+// RUN: vast-cc --ccopts -xc --from-source --emit-bytecode %s > %t.vbc
+// RUN: vast-query --show-symbols=all --scope=foo %t.vbc | FileCheck %s -check-prefix=FOO
+// RUN: vast-query --show-symbols=vars --scope=main %t.vbc | FileCheck %s -check-prefix=MAIN
+// RUN: vast-query --symbol-users=a --scope=main %t.vbc | FileCheck %s -check-prefix=USERS
+// RUN: vast-query --show-symbols=functions %t.vbc | FileCheck %s -check-prefix=FUN
+// RUN: vast-query --show-symbols=vars --scope=main --materialization-stats %t.vbc 2>&1 > /dev/null | FileCheck %s -check-prefix=LAZY
+// RUN: vast-query --show-symbols=vars --materialization-stats %t.vbc 2>&1 > /dev/null | FileCheck %s -check-prefix=EAGER
+
+// definitions out of the scope stay in the bytecode
+// LAZY: materialized 1 of {{[2-9]}} definitions
+// EAGER: materialized [[COUNT:[0-9]+]] of [[COUNT]] definitions
+
+struct point { int x, y; };
+
+// FOO-DAG: func : foo
+// FOO-DAG: hl.var : a
+// FOO-NOT: func : main
+// FUN-DAG: func : foo
+int foo() {
+    int a;
+    return a;
+}
+
+// FUN-DAG: func : bar
+int bar(void);
+
+// MAIN-DAG: hl.var : a
+// MAIN-DAG: hl.var : p
+// MAIN-NOT: hl.var : b
+// USERS: hl.ref %0 : !hl.lvalue<!hl.int>
+// USERS: hl.ref %0 : !hl.lvalue<!hl.int>
+// FUN-DAG: func : main
+int main()
+{
+    int a = 1;
+    struct point p = { a, a };
+    return p.x;
+}
+
+int baz() {
+    int b;
+    return b;
+}
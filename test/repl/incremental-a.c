@@ -0,0 +1,34 @@
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: cp %s first.c
+// RUN: sed -e 's/^    return v + 1;$/    int w = v + 2;\n    return w;/' %s > second.c
+// RUN: printf 'load first.c\nshow stats\nload second.c\nshow locations\nshow stats\nexit\n' | vast-repl > incremental.out
+// RUN: FileCheck %s < incremental.out
+// RUN: FileCheck %s --check-prefix=LOC < incremental.out
+// RUN: printf 'load second.c\nshow locations\nexit\n' | vast-repl > fresh.out
+// RUN: grep -v '^reused bodies' incremental.out | diff - fresh.out
+
+// CHECK: reused bodies: 0, emitted bodies: 2
+// CHECK: hl.func {{.*}}@edited
+// CHECK: hl.func {{.*}}@unchanged
+// CHECK: reused bodies: 1, emitted bodies: 1
+
+// the body of `edited` is emitted anew, the old one is gone
+// LOC-LABEL: hl.func {{.*}}@edited
+// LOC-NOT: #hl.integer<1>
+// LOC: hl.var "w"
+// LOC: hl.return {{.*}}loc("input.cc":30:5)
+
+// the body of `unchanged` is moved from the first emission, its return is
+// relocated by the line inserted to `edited`
+// LOC-LABEL: hl.func {{.*}}@unchanged
+// LOC-NOT: hl.return {{.*}}loc("input.cc":33:5)
+// LOC: hl.return {{.*}}loc("input.cc":34:5)
+// LOC-NOT: hl.return
+
+int edited(int v) {
+    return v + 1;
+}
+
+int unchanged(int v) {
+    return v * 2;
+}
@@ -0,0 +1,29 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.var "table" : !hl.lvalue<!hl.array<16, !hl.int< unsigned >>> = {
+// CHECK:   [[V1:%[0-9]+]] = hl.const.dense dense<[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 0]> : tensor<16xi32> : !hl.array<16, !hl.int< unsigned >>
+// CHECK:   hl.value.yield [[V1]] : !hl.array<16, !hl.int< unsigned >>
+unsigned int table[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+// CHECK: hl.var "grid" : !hl.lvalue<!hl.array<4, !hl.array<4, !hl.short>>> = {
+// CHECK:   hl.const.dense dense<{{\[}}[-1, 2, 0, 0], [0, 0, 0, 0], [3, 0, 0, 0], [4, 5, 6, 7]]> : tensor<4x4xi16> : !hl.array<4, !hl.array<4, !hl.short>>
+short grid[4][4] = { { -1, 2 }, { }, { 1 + 2 }, { 4, 5, 6, 7 } };
+
+// CHECK: hl.var "names" : !hl.lvalue<!hl.array<4, !hl.array<4, !hl.char>>> = {
+// CHECK:   hl.const.dense dense<{{\[}}[97, 98, 99, 0], [100, 101, 0, 0], [0, 0, 0, 0], [102, 0, 0, 0]]> : tensor<4x4xi8>
+char names[4][4] = { "abc", "de", "", "f" };
+
+// CHECK: hl.var "weights" : !hl.lvalue<!hl.array<16, !hl.float>> = {
+// CHECK:   hl.const.dense dense<{{.*}}> : tensor<16xf32> : !hl.array<16, !hl.float>
+float weights[16] = { 0.5f, 1.5f, 2.5f };
+
+// CHECK: hl.var "wide" : !hl.lvalue<!hl.array<5, !hl.int>> = {
+// CHECK:   hl.const.dense dense<[118, 97, 115, 116, 0]> : tensor<5xi32> : !hl.array<5, !hl.int>
+int wide[] = L"vast";
+
+// CHECK: hl.var "dynamic" : !hl.lvalue<!hl.array<16, !hl.int>> = {
+// CHECK:   hl.initlist
+void f(int x) {
+    int dynamic[16] = { x };
+}
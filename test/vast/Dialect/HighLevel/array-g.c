@@ -0,0 +1,20 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.var "buffer" : !hl.lvalue<!hl.array<268435456, !hl.char>> = {
+// CHECK:   hl.const.dense dense<0> : tensor<268435456xi8> : !hl.array<268435456, !hl.char>
+char buffer[1 << 28] = { 0 };
+
+// CHECK: hl.var "zeros" : !hl.lvalue<!hl.array<1024, !hl.float>> = {
+// CHECK:   hl.const.dense dense<0.000000e+00> : tensor<1024xf32> : !hl.array<1024, !hl.float>
+float zeros[1024] = { 0.0f };
+
+// CHECK: hl.var "ones" : !hl.lvalue<!hl.array<4, !hl.array<4, !hl.int>>> = {
+// CHECK:   hl.const.dense dense<1> : tensor<4x4xi32> : !hl.array<4, !hl.array<4, !hl.int>>
+int ones[4][4] = { { 1, 1, 1, 1 }, { 1, 1, 1, 1 }, { 1, 1, 1, 1 }, { 1, 1, 1, 1 } };
+
+// sparse initializers of large arrays keep their explicit elements
+// CHECK: hl.var "sparse" : !hl.lvalue<!hl.array<1048576, !hl.int>> = {
+// CHECK-NOT: hl.const.dense
+// CHECK:   hl.initlist
+int sparse[1 << 20] = { 1, 2 };
@@ -0,0 +1,21 @@
+// RUN: vast-cc --from-source %s | FileCheck %s
+// RUN: vast-cc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.func external @twice ([[A1:%arg[0-9]+]]: !hl.lvalue<!hl.int>) -> !hl.int {
+int twice(int);
+
+// CHECK: hl.func external @nonproto ([[A2:%arg[0-9]+]]: !hl.lvalue<!hl.int>) -> !hl.int {
+int nonproto();
+
+// CHECK: hl.func external @caller () -> !hl.int
+int caller(void) {
+    // CHECK: hl.call @twice([[V1:%[0-9]+]]) : (!hl.int) -> !hl.int
+    return twice(7);
+}
+
+int twice(int v) { return v + v; }
+
+int nonproto(int v) { return v; }
+
+// CHECK-NOT: @twice
+// CHECK-NOT: @nonproto
@@ -0,0 +1,20 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types="conversion-driver=true" | FileCheck %s
+
+// CHECK: hl.var "p" : !hl.lvalue<!hl.ptr<si32>>
+int *p;
+
+// CHECK: hl.var "pp" : !hl.lvalue<!hl.ptr<!hl.ptr<ui64>>>
+unsigned long **pp;
+
+// CHECK: hl.var "cp" : !hl.lvalue<!hl.ptr<si16{{.*}}>>
+short *const cp;
+
+// CHECK: hl.var "vp" : !hl.lvalue<!hl.ptr<ui8>>
+void *vp;
+
+// CHECK: hl.var "ap" : !hl.lvalue<memref<4x!hl.ptr<f32>>>
+float *ap[4];
+
+// CHECK: hl.func external @deref {{.*}}!hl.ptr<si32>{{.*}} -> si32
+int deref(int *ptr) { return *ptr; }
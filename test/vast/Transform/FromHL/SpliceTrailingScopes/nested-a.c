@@ -0,0 +1,38 @@
+// RUN: vast-cc --ccopts -xc --from-source %s > %t
+// RUN: vast-opt --vast-hl-splice-trailing-scopes %t | diff -B %t -
+// RUN: FileCheck %s < %t
+// RUN: rm -rf %t.repl && mkdir -p %t.repl && cd %t.repl
+// RUN: printf 'load %s\nshow module\nexit\n' | vast-repl | FileCheck %s
+
+// CHECK-LABEL: hl.func external @nested
+int nested(int n)
+{
+    // CHECK-NOT: hl.scope
+    // CHECK: hl.var "a"
+    // CHECK: hl.var "b"
+    // CHECK: hl.var "c"
+    {
+        int a = n;
+        {
+            int b = a;
+            {
+                int c = b;
+                return c;
+            }
+        }
+    }
+}
+
+// CHECK-LABEL: hl.func external @loop
+void loop(int n)
+{
+    // CHECK: hl.while
+    while (n) {
+        // CHECK-NOT: hl.scope
+        // CHECK: hl.var "d"
+        {
+            int d = n--;
+        }
+    }
+    // CHECK: hl.return
+}
@@ -0,0 +1,7 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-ll-vars --vast-core-to-llvm | FileCheck %s
+
+// CHECK: llvm.mlir.global external @table(dense<[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]> : tensor<16xi32>){{.*}} : !llvm.array<16 x i32>
+int table[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+// CHECK: llvm.mlir.global internal @message("vast\00\00\00\00"){{.*}} : !llvm.array<8 x i8>
+static char message[8] = "vast";
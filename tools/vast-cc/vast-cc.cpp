@@ -7,10 +7,15 @@ VAST_RELAX_WARNINGS
 #include <mlir/Tools/mlir-translate/MlirTranslateMain.h>
 VAST_UNRELAX_WARNINGS
 
+#include <vast/Translation/Batch.hpp>
 #include <vast/Translation/Register.hpp>
 
 int main(int argc, char **argv)
 {
+    if (vast::hl::is_batch_translation(argc, argv)) {
+        return failed(vast::hl::run_batch_translation(argc, argv));
+    }
+
     vast::registerAllTranslations();
 
     return failed(
@@ -3,29 +3,181 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/DebugCounter.h"
 #include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/Timing.h"
 #include "mlir/Target/LLVMIR/Dialect/All.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
 
-#include "vast/Conversion/Passes.hpp"
-
-#include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Bytecode/Bytecode.hpp"
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+namespace vast::opt
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    // The options of the mlir-opt driver, that is reimplemented here so that
+    // modules can be read from and written to bytecode.
+    struct vast_opt_options {
+        cl::opt< std::string > input_file{
+            cl::Positional, cl::desc("<input file>"), cl::init("-")
+        };
+        cl::opt< std::string > output_file{ "o",
+            cl::desc("Output filename"), cl::value_desc("filename"), cl::init("-")
+        };
+        cl::opt< bool > split_input_file{ "split-input-file",
+            cl::desc("Split the input file into pieces and process each chunk independently"),
+            cl::init(false)
+        };
+        cl::opt< bool > verify_diagnostics{ "verify-diagnostics",
+            cl::desc("Check that emitted diagnostics match expected-* lines on the corresponding line"),
+            cl::init(false)
+        };
+        cl::opt< bool > verify_passes{ "verify-each",
+            cl::desc("Run the verifier after each transformation pass"),
+            cl::init(true)
+        };
+        cl::opt< bool > allow_unregistered_dialects{ "allow-unregistered-dialect",
+            cl::desc("Allow operation with no registered dialects"),
+            cl::init(false)
+        };
+        cl::opt< bool > show_dialects{ "show-dialects",
+            cl::desc("Print the list of registered dialects"),
+            cl::init(false)
+        };
+        cl::opt< bool > emit_bytecode{ "emit-bytecode",
+            cl::desc("Write the resulting module in the vast bytecode"),
+            cl::init(false)
+        };
+    };
+    // clang-format on
+
+    static llvm::ManagedStatic< vast_opt_options > options;
+
+    void register_options() {
+        *options;
+        mlir::registerAsmPrinterCLOptions();
+        mlir::registerMLIRContextCLOptions();
+        mlir::registerPassManagerCLOptions();
+        mlir::registerDefaultTimingManagerCLOptions();
+        mlir::DebugCounter::registerCLOptions();
+    }
+
+    // Runs the pipeline on a module loaded from bytecode or text, the result
+    // is written in the requested form.
+    mlir::LogicalResult process_module(
+        llvm::raw_ostream &os, std::unique_ptr< llvm::MemoryBuffer > buffer,
+        const mlir::PassPipelineCLParser &pipeline, mlir::DialectRegistry &registry
+    ) {
+        MContext ctx(registry);
+        ctx.allowUnregisteredDialects(options->allow_unregistered_dialects);
+
+        llvm::SourceMgr mgr;
+        mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+        mlir::SourceMgrDiagnosticHandler handler(mgr, &ctx);
+
+        // parse without threading, it only adds context synchronization
+        bool threading = ctx.isMultithreadingEnabled();
+        ctx.disableMultithreading();
+        auto mod = bytecode::load_module(mgr, &ctx);
+        ctx.enableMultithreading(threading);
+        if (!mod) {
+            return mlir::failure();
+        }
+
+        mlir::PassManager pm(&ctx, mlir::OpPassManager::Nesting::Implicit);
+        pm.enableVerifier(options->verify_passes);
+        mlir::applyPassManagerCLOptions(pm);
+        mlir::applyDefaultTimingPassManagerCLOptions(pm);
+
+        auto error_handler = [&] (const llvm::Twine &msg) {
+            mlir::emitError(mlir::UnknownLoc::get(&ctx)) << msg;
+            return mlir::failure();
+        };
+
+        if (mlir::failed(pipeline.addToPipeline(pm, error_handler))) {
+            return mlir::failure();
+        }
+
+        if (mlir::failed(pm.run(*mod))) {
+            return mlir::failure();
+        }
+
+        if (options->emit_bytecode) {
+            return bytecode::write_bytecode(mod.get(), os);
+        }
+
+        mod->print(os);
+        os << '\n';
+        return mlir::success();
+    }
+
+    mlir::LogicalResult run(const mlir::PassPipelineCLParser &pipeline, mlir::DialectRegistry &registry) {
+        if (options->show_dialects) {
+            llvm::outs() << "Available Dialects: ";
+            llvm::interleaveComma(registry.getDialectNames(), llvm::outs());
+            llvm::outs() << "\n";
+            return mlir::success();
+        }
+
+        std::string err;
+        auto input = mlir::openInputFile(options->input_file, &err);
+        if (!input) {
+            llvm::errs() << err << "\n";
+            return mlir::failure();
+        }
+
+        auto output = mlir::openOutputFile(options->output_file, &err);
+        if (!output) {
+            llvm::errs() << err << "\n";
+            return mlir::failure();
+        }
+
+        auto use_bytecode = options->emit_bytecode || bytecode::is_bytecode(input->getBuffer());
+        if (use_bytecode && (options->split_input_file || options->verify_diagnostics)) {
+            llvm::errs() << "error: bytecode does not support split input files and verification of diagnostics\n";
+            return mlir::failure();
+        }
+
+        auto result = use_bytecode
+            ? process_module(output->os(), std::move(input), pipeline, registry)
+            : mlir::MlirOptMain(
+                output->os(), std::move(input), pipeline, registry,
+                options->split_input_file, options->verify_diagnostics,
+                options->verify_passes, options->allow_unregistered_dialects
+            );
+
+        if (mlir::failed(result)) {
+            return mlir::failure();
+        }
+
+        output->keep();
+        return mlir::success();
+    }
+
+} // namespace vast::opt
 
 int main(int argc, char **argv)
 {
+    llvm::InitLLVM init(argc, argv);
+
     mlir::registerAllPasses();
     // Register VAST passes here
     vast::hl::registerPasses();
@@ -36,7 +188,10 @@ int main(int argc, char **argv)
     mlir::registerAllToLLVMIRTranslations(registry);
     vast::hl::registerHLToLLVMIR(registry);
     mlir::registerAllDialects(registry);
-    return failed(
-        mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry)
-    );
+
+    vast::opt::register_options();
+    mlir::PassPipelineCLParser pipeline("", "Compiler passes to run");
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST Optimizer driver\n");
+
+    return failed(vast::opt::run(pipeline, registry));
 }
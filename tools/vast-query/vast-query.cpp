@@ -13,11 +13,13 @@ VAST_RELAX_WARNINGS
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "mlir/Parser/Parser.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Bytecode/Bytecode.hpp"
 #include "vast/Dialect/Dialects.hpp"
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
@@ -74,6 +76,11 @@ namespace vast::cl
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< bool > materialization_stats{ "materialization-stats",
+            cl::desc("Report how many definitions of a bytecode module were materialized"),
+            cl::init(false),
+            cl::cat(queries)
+        };
     };
     // clang-format on
 
@@ -103,22 +110,22 @@ namespace vast::query
         };
     }
 
-    void show_value(auto value) {
-        llvm::outs() << util::show_symbol_value(value) << "\n";
+    void show_value(auto value, meta::offset_resolver &resolver) {
+        llvm::outs() << util::show_symbol_value(value, resolver) << "\n";
     }
 
-    logical_result do_show_symbols(auto scope) {
+    logical_result do_show_symbols(auto scope, meta::offset_resolver &resolver) {
         auto &show_kind = cl::options->show_symbols;
 
-        auto show_if = [=](auto symbol, auto pred) {
+        auto show_if = [&](auto symbol, auto pred) {
             if (pred(symbol))
-                show_value(symbol);
+                show_value(symbol, resolver);
         };
 
-        auto filter_kind = [=](cl::show_symbol_type kind) {
-            return [=](auto symbol) {
+        auto filter_kind = [&](cl::show_symbol_type kind) {
+            return [&, kind](auto symbol) {
                 switch (kind) {
-                    case cl::show_symbol_type::all: show_value(symbol); break;
+                    case cl::show_symbol_type::all: show_value(symbol, resolver); break;
                     case cl::show_symbol_type::type:
                         show_if(symbol, is_one_of< hl::TypeDefOp, hl::TypeDeclOp >());
                         break;
@@ -143,11 +150,11 @@ namespace vast::query
         return mlir::success();
     }
 
-    logical_result do_show_users(auto scope) {
+    logical_result do_show_users(auto scope, meta::offset_resolver &resolver) {
         auto &name = cl::options->show_symbol_users;
-        util::yield_users(name.getValue(), scope, [](auto user) {
+        util::yield_users(name.getValue(), scope, [&](auto user) {
             user->print(llvm::outs());
-            llvm::outs() << util::show_location(*user) << "\n";
+            llvm::outs() << util::show_location(*user, resolver) << "\n";
         });
 
         return mlir::success();
@@ -167,9 +174,37 @@ namespace vast
         return result;
     }
 
+    // Bytecode is opened lazily, a constrained query materializes only
+    // definitions of its scope.
+    OwningModuleRef load_bytecode(MContext &ctx, memory_buffer buffer) {
+        auto lazy = bytecode::lazy_module::open(std::move(buffer), &ctx);
+        if (!lazy) {
+            return nullptr;
+        }
+
+        auto materialized = query::constrained_scope()
+            ? lazy->materialize(cl::options->scope_name.getValue())
+            : lazy->materialize_all();
+
+        if (mlir::failed(materialized)) {
+            return nullptr;
+        }
+
+        if (cl::options->materialization_stats) {
+            const auto &index = lazy->index();
+            auto count = llvm::count_if(index, [] (const auto &entry) { return entry.materialized(); });
+            llvm::errs() << "materialized " << count << " of " << index.size() << " definitions\n";
+        }
+
+        return lazy->release();
+    }
+
     logical_result do_query(MContext &ctx, memory_buffer buffer) {
         llvm::SourceMgr source_mgr;
-        source_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+        auto is_bytecode = bytecode::is_bytecode(buffer->getBuffer());
+        if (!is_bytecode) {
+            source_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+        }
 
         mlir::SourceMgrDiagnosticHandler manager_handler(source_mgr, &ctx);
 
@@ -178,20 +213,27 @@ namespace vast
         bool wasThreadingEnabled = ctx.isMultithreadingEnabled();
         ctx.disableMultithreading();
 
-        OwningModuleRef mod(mlir::parseSourceFile< mlir::ModuleOp >(source_mgr, &ctx));
+        // the input is either in the textual form or in the vast bytecode
+        OwningModuleRef mod(is_bytecode
+            ? load_bytecode(ctx, std::move(buffer))
+            : mlir::parseSourceFile< mlir::ModuleOp >(source_mgr, &ctx)
+        );
         ctx.enableMultithreading(wasThreadingEnabled);
         if (!mod) {
             llvm::errs() << "error: cannot parse module\n";
             return mlir::failure();
         }
 
+        // compact locations are resolved from the sources
+        meta::offset_resolver resolver;
+
         auto process_scope = [&] (auto scope) {
             if (query::show_symbols()) {
-                return query::do_show_symbols(scope);
+                return query::do_show_symbols(scope, resolver);
             }
 
             if (query::show_symbol_users()) {
-                return query::do_show_users(scope);
+                return query::do_show_users(scope, resolver);
             }
 
             return mlir::success();
@@ -224,8 +266,8 @@ int main(int argc, char **argv) {
     vast::registerAllDialects(registry);
     mlir::registerAllDialects(registry);
 
+    // dialects are loaded on demand by the parser
     vast::MContext ctx(registry);
-    ctx.loadAllAvailableDialects();
 
     std::exit(failed(vast::run(ctx)));
 }
@@ -5,7 +5,7 @@
 
 #include "vast/repl/state.hpp"
 
-#include "vast/Translation/CodeGen.hpp"
+#include "vast/Translation/CodeGenDriver.hpp"
 
 #include <fstream>
 
@@ -29,7 +29,16 @@ namespace vast::repl::codegen {
     owning_module_ref emit_module(const std::string &source, MContext *mctx) {
         auto unit = codegen::ast_from_source(source);
         auto &actx = unit->getASTContext();
-        vast::hl::DefaultCodeGen codegen(&actx, mctx);
+        vast::hl::CodeGenDriver codegen(&actx, mctx);
+        return codegen.emit_module(actx.getTranslationUnitDecl());
+    }
+
+    owning_module_ref emit_module(
+        const std::string &source, MContext *mctx, hl::incremental_state &incremental
+    ) {
+        auto unit = codegen::ast_from_source(source);
+        auto &actx = unit->getASTContext();
+        vast::hl::CodeGenDriver codegen(&actx, mctx, { .incremental = &incremental });
         return codegen.emit_module(actx.getTranslationUnitDecl());
     }
 
@@ -17,9 +17,17 @@ namespace vast::repl::cmd {
     }
 
     void check_and_emit_module(state_t &state) {
+        if (!state.mod && state.lazy) {
+            if (mlir::failed(state.lazy->materialize_all())) {
+                throw std::runtime_error("error: cannot load module");
+            }
+            state.mod = state.lazy->release();
+            state.lazy.reset();
+        }
+
         if (!state.mod) {
             const auto &source = get_source(state);
-            state.mod = codegen::emit_module(source, &state.ctx);
+            state.mod = codegen::emit_module(source, &state.ctx, state.incremental);
         }
     }
 
@@ -40,8 +48,33 @@ namespace vast::repl::cmd {
     //
     // load command
     //
+    void load_bytecode(state_t &state, std::unique_ptr< llvm::MemoryBuffer > buffer) {
+        state.lazy = bytecode::lazy_module::open(std::move(buffer), &state.ctx);
+        if (!state.lazy) {
+            throw std::runtime_error("error: cannot load module");
+        }
+
+        state.source.reset();
+        state.mod = nullptr;
+        state.incremental.previous = nullptr;
+        state.incremental.reused = state.incremental.emitted = 0;
+    }
+
     void load::run(state_t &state) const {
-        auto source  = get_param< source_param >(params);
+        auto source = get_param< source_param >(params);
+
+        // modules in the vast bytecode are loaded lazily
+        auto file = llvm::MemoryBuffer::getFile(
+            source.path.string(), /* IsText */ false, /* RequiresNullTerminator */ false
+        );
+        if (file && bytecode::is_bytecode((*file)->getBuffer())) {
+            return load_bytecode(state, std::move(*file));
+        }
+
+        // the module is emitted again on demand, unchanged function bodies
+        // are moved from the stale one, if it was emitted from a source
+        state.incremental.previous = state.source ? std::move(state.mod) : nullptr;
+        state.lazy.reset();
         state.source = codegen::get_source(source.path);
     };
 
@@ -63,21 +96,56 @@ namespace vast::repl::cmd {
         llvm::outs() << state.mod.get() << "\n";
     }
 
+    void show_locations(state_t &state) {
+        check_and_emit_module(state);
+        // locations are printed next to their operations, not as aliases
+        state.mod->print(llvm::outs(), mlir::OpPrintingFlags().enableDebugInfo().useLocalScope());
+        llvm::outs() << "\n";
+    }
+
     void show_symbols(state_t &state) {
+        // sources may change between commands, hence their lines are not kept
+        meta::offset_resolver resolver;
+
+        // symbols of a lazily loaded module are listed from its index,
+        // without materialization
+        if (state.lazy) {
+            util::symbols(state.lazy->module(), [&] (auto symbol) {
+                llvm::outs() << util::show_symbol_value(symbol, resolver) << "\n";
+            });
+
+            for (const auto &entry : state.lazy->index()) {
+                if (!entry.materialized()) {
+                    llvm::outs() << entry.operation << " : " << entry.symbol << "\n";
+                }
+            }
+            return;
+        }
+
         check_and_emit_module(state);
 
         util::symbols(state.mod.get(), [&] (auto symbol) {
-            llvm::outs() << util::show_symbol_value(symbol) << "\n";
+            llvm::outs() << util::show_symbol_value(symbol, resolver) << "\n";
         });
     }
 
+    // function bodies reused from the previous emission of the source
+    void show_stats(state_t &state) {
+        check_and_emit_module(state);
+        const auto &incremental = state.incremental;
+        llvm::outs() << "reused bodies: " << incremental.reused
+                     << ", emitted bodies: " << incremental.emitted << "\n";
+    }
+
     void show::run(state_t &state) const {
         auto what = get_param< kind_param >(params);
         switch (what) {
-            case show_kind::source:  return show_source(state);
-            case show_kind::ast:     return show_ast(state);
-            case show_kind::module:  return show_module(state);
-            case show_kind::symbols: return show_symbols(state);
+            case show_kind::source:    return show_source(state);
+            case show_kind::ast:       return show_ast(state);
+            case show_kind::module:    return show_module(state);
+            case show_kind::locations: return show_locations(state);
+            case show_kind::symbols:   return show_symbols(state);
+            case show_kind::stats:     return show_stats(state);
         }
     };
 
@@ -115,4 +183,26 @@ namespace vast::repl::cmd {
         }
     };
 
+    //
+    // symbol command
+    //
+    void symbol::run(state_t &state) const {
+        auto name = get_param< symbol_param >(params).value;
+
+        if (state.lazy) {
+            if (mlir::failed(state.lazy->materialize(name))) {
+                throw std::runtime_error("error: cannot load symbol " + name);
+            }
+        } else {
+            check_and_emit_module(state);
+        }
+
+        auto mod = state.lazy ? state.lazy->module() : state.mod.get();
+        util::symbols(mod, [&] (auto symbol) {
+            if (util::symbol_name(symbol) == name) {
+                llvm::outs() << symbol << "\n";
+            }
+        });
+    };
+
 } // namespace vast::repl::cmd
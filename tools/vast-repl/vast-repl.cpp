@@ -87,8 +87,8 @@ int main(int argc, char **argv) try {
 
     args_t args = load_args(argc, argv);
 
+    // dialects are loaded on demand, by the parser or by the codegen
     vast::MContext ctx(registry);
-    ctx.loadAllAvailableDialects();
 
     auto prompt = vast::repl::prompt(ctx);
 